@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include "nlohmann/json.hpp"
+
+using nlohmann::json;
+
+/**
+ * The number of requests in the generated log.
+ */
+#define BENCH_LOG_REQUESTS 200000
+
+/**
+ * The number of timed runs, of which the best is reported.
+ */
+#define BENCH_RUNS 5
+
+/**
+ * Builds a pretty-printed log of plugin requests, with the strings,
+ * escapes and nesting seen in real logs.
+ */
+static std::string MakeRequestLog()
+{
+  json log = json::array();
+  for (int i = 0; i < BENCH_LOG_REQUESTS; ++i) {
+    json request;
+    request["id"] = i;
+    request["method"] = i % 3 ? "execute" : "executeBatch";
+    request["input"] = { { "operandA", i * 0.5 }, { "operandB", -1.0 / (i + 1) } };
+    request["client"] = "calculator-client/1.0 (\"request\\log\" \xC3\xA9t\xC3\xA9)";
+    request["tags"] = { "arithmetic", "logged", i % 2 ? "retry" : "first" };
+    log.push_back(request);
+  }
+  return log.dump(2);
+}
+
+/**
+ * Runs the given parse repeatedly, and returns the best throughput in MB/s.
+ */
+template<typename Parse>
+static double MeasureThroughput(const std::string &text, Parse parse)
+{
+  double best = 0;
+  for (int run = 0; run < BENCH_RUNS; ++run) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (!parse(text)) {
+      std::printf("parse failed\n");
+      return 0;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    best = std::max(best, text.size() / 1e6 / elapsed.count());
+  }
+  return best;
+}
+
+
+/**
+ * Compares the lexer throughput on a contiguous buffer, which is scanned in
+ * bulk, with a stream, which is read one character at a time through the
+ * input adapter (the path all inputs took before), for validation only
+ * (accept) and for building the tree (parse).
+ */
+int main()
+{
+  const std::string log = MakeRequestLog();
+  std::printf("request log: %.1f MB\n", log.size() / 1e6);
+
+  const double acceptBuffer = MeasureThroughput(log, [](const std::string &text) {
+    return json::accept(text);
+  });
+  const double acceptStream = MeasureThroughput(log, [](const std::string &text) {
+    std::istringstream stream(text);
+    return json::accept(stream);
+  });
+  const double parseBuffer = MeasureThroughput(log, [](const std::string &text) {
+    return json::parse(text).size() == BENCH_LOG_REQUESTS;
+  });
+  const double parseStream = MeasureThroughput(log, [](const std::string &text) {
+    std::istringstream stream(text);
+    return json::parse(stream).size() == BENCH_LOG_REQUESTS;
+  });
+
+  std::printf("%8s %16s %16s\n", "", "stream (MB/s)", "buffer (MB/s)");
+  std::printf("%8s %16.1f %16.1f\n", "accept", acceptStream, acceptBuffer);
+  std::printf("%8s %16.1f %16.1f\n", "parse", parseStream, parseBuffer);
+  return 0;
+}
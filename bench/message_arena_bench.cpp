@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+#include "message_arena.h"
+
+/**
+ * The number of requests handled by each thread.
+ */
+#define BENCH_REQUESTS 200000
+
+/**
+ * A request message, with a string that does not fit the small string buffer.
+ */
+static const char *s_request =
+  "{\"method\": \"execute\", \"input\": {\"operandA\": 1.5, \"operandB\": 2.25},"
+  " \"comment\": \"a request comment that is longer than the small string buffer\"}";
+
+/**
+ * Handles a request the way a plugin host does: parses it, reads and
+ * modifies the inputs, and builds and serializes a reply.
+ */
+template<typename Json>
+static double HandleRequest(int i)
+{
+  Json request = Json::parse(s_request);
+  request["input"]["operandA"] = static_cast<double>(i);
+  Json reply;
+  reply["result"] = request["input"]["operandA"].template get<double>()
+                    + request["input"]["operandB"].template get<double>();
+  reply["comment"] = request["comment"];
+  return reply["result"].template get<double>() + static_cast<double>(reply.dump().size());
+}
+
+/**
+ * Handles requests on the given number of threads, with messages allocated
+ * from the heap or from the arena, and returns the time per request (total
+ * time over all requests) in nanoseconds.
+ */
+template<typename Json, bool UseArena>
+static double Measure(int threads, double &checksum)
+{
+  std::vector<std::thread> workers;
+  std::vector<double> sums(threads);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int t = 0; t < threads; ++t) {
+    workers.emplace_back([t, &sums] {
+      double sum = 0;
+      for (int i = 0; i < BENCH_REQUESTS; ++i) {
+        if (UseArena) {
+          MessageArena::Scope scope;
+          sum += HandleRequest<Json>(i);
+        } else {
+          sum += HandleRequest<Json>(i);
+        }
+      }
+      sums[t] = sum;
+    });
+  }
+  for (std::thread &worker : workers) {
+    worker.join();
+  }
+  std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  for (double sum : sums) {
+    checksum += sum;
+  }
+  return elapsed.count() / (static_cast<double>(BENCH_REQUESTS) * threads);
+}
+
+
+/**
+ * Compares handling requests with heap-allocated messages (flat_json) and
+ * with arena-allocated messages (ArenaJson), as the number of threads that
+ * handle requests concurrently grows.
+ */
+int main()
+{
+  double checksum = 0;
+  std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+  std::printf("%8s %22s %22s\n", "threads", "heap (ns/request)", "arena (ns/request)");
+  for (int threads : { 1, 2, 4, 8, 16 }) {
+    const double heap = Measure<nlohmann::flat_json, false>(threads, checksum);
+    const double arena = Measure<ArenaJson, true>(threads, checksum);
+    std::printf("%8d %22.1f %22.1f\n", threads, heap, arena);
+  }
+  std::printf("checksum: %g\n", checksum);
+  return 0;
+}
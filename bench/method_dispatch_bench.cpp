@@ -0,0 +1,81 @@
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "plugin_method.h"
+
+/**
+ * The number of lookups timed for each case.
+ */
+#define BENCH_LOOKUPS 4000000
+
+/**
+ * Times the given lookup over the given names, and returns the average time
+ * per lookup in ns.
+ */
+template<typename Name, typename Lookup>
+static double TimeLookups(const std::vector<Name> &names, Lookup lookup)
+{
+  long checksum = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+    checksum += lookup(names[i % names.size()]);
+  }
+  std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+  // Keeps the lookups from being optimized away
+  if (checksum == -1) {
+    std::printf("unreachable\n");
+  }
+  return static_cast<double>(elapsed.count()) / BENCH_LOOKUPS;
+}
+
+
+/**
+ * Compares the cost of resolving a method name through a chain of string
+ * comparisons (the original invokeMethod dispatch) with the method table,
+ * looked up by name and by precomputed symbol, for growing method counts.
+ * Every method is looked up in turn, along with as many unknown names.
+ */
+int main()
+{
+  const std::size_t methodCounts[] = { 1, 4, 16, 64, 256 };
+
+  std::printf("%8s %16s %16s %16s\n", "methods", "compare (ns)", "table name (ns)", "table sym (ns)");
+  for (std::size_t methodCount : methodCounts) {
+    std::vector<std::string> methodNames;
+    for (std::size_t i = 0; i < methodCount; ++i) {
+      methodNames.push_back("method_" + std::to_string(i));
+    }
+    std::vector<MethodDescriptor> methods(methodCount);
+    for (std::size_t i = 0; i < methodCount; ++i) {
+      methods[i].name = methodNames[i].c_str();
+    }
+    MethodTable table(methods.data(), methods.size());
+
+    std::vector<std::string> names(methodNames);
+    for (std::size_t i = 0; i < methodCount; ++i) {
+      names.push_back("unknown_" + std::to_string(i));
+    }
+    std::vector<MethodSymbol> symbols;
+    for (const std::string &name : names) {
+      symbols.push_back(MethodSymbol(name.data(), name.size()));
+    }
+
+    const double compareTime = TimeLookups(names, [&methodNames](const std::string &name) {
+      for (std::size_t i = 0; i < methodNames.size(); ++i) {
+        if (methodNames[i] == name) {
+          return static_cast<MethodId>(i);
+        }
+      }
+      return static_cast<MethodId>(PLUGIN_METHOD_INVALID);
+    });
+    const double nameTime = TimeLookups(names, [&table](const std::string &name) {
+      return table.find(name.data(), name.size());
+    });
+    const double symbolTime = TimeLookups(symbols, [&table](const MethodSymbol &symbol) {
+      return table.find(symbol);
+    });
+    std::printf("%8zu %16.1f %16.1f %16.1f\n", methodCount, compareTime, nameTime, symbolTime);
+  }
+  return 0;
+}
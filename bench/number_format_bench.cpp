@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "nlohmann/json.hpp"
+
+using nlohmann::detail::to_chars;
+
+/**
+ * The number of values of each type.
+ */
+#define BENCH_VALUES 1000000
+
+/**
+ * The number of timed runs, of which the best is reported.
+ */
+#define BENCH_RUNS 5
+
+/**
+ * Builds finite values of the given type from random bit patterns.
+ */
+template<typename FloatType, typename Bits>
+static std::vector<FloatType> MakeValues()
+{
+  std::mt19937_64 random(42);
+  std::vector<FloatType> values;
+  values.reserve(BENCH_VALUES);
+  while (values.size() < BENCH_VALUES) {
+    const Bits bits = static_cast<Bits>(random());
+    FloatType value;
+    std::memcpy(&value, &bits, sizeof(value));
+    if (std::isfinite(value)) {
+      values.push_back(value);
+    }
+  }
+  return values;
+}
+
+/**
+ * Formats all values with the given conversion repeatedly, and returns the
+ * best time per value in nanoseconds. The output lengths are accumulated
+ * into the checksum.
+ */
+template<typename FloatType, typename Format>
+static double Measure(const std::vector<FloatType> &values, Format format, std::size_t &checksum)
+{
+  double best = 1e30;
+  char buffer[64];
+  for (int run = 0; run < BENCH_RUNS; ++run) {
+    std::size_t length = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (FloatType value : values) {
+      length += format(buffer, value);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count() / values.size());
+    checksum += length;
+  }
+  return best;
+}
+
+
+/**
+ * Compares the shortest round-trip formatting of the serializer (to_chars)
+ * with printf at the precision that round-trips (max_digits10), for random
+ * doubles and floats.
+ */
+int main()
+{
+  std::size_t checksum = 0;
+  const std::vector<double> doubles = MakeValues<double, uint64_t>();
+  const std::vector<float> floats = MakeValues<float, uint32_t>();
+
+  const double doublePrintf = Measure(doubles, [](char *buffer, double value) {
+    return static_cast<std::size_t>(std::snprintf(buffer, 64, "%.17g", value));
+  }, checksum);
+  const double doubleToChars = Measure(doubles, [](char *buffer, double value) {
+    return static_cast<std::size_t>(to_chars(buffer, buffer + 64, value) - buffer);
+  }, checksum);
+  const double floatPrintf = Measure(floats, [](char *buffer, float value) {
+    return static_cast<std::size_t>(std::snprintf(buffer, 64, "%.9g", value));
+  }, checksum);
+  const double floatToChars = Measure(floats, [](char *buffer, float value) {
+    return static_cast<std::size_t>(to_chars(buffer, buffer + 64, value) - buffer);
+  }, checksum);
+
+  std::printf("%8s %16s %16s\n", "", "printf (ns)", "to_chars (ns)");
+  std::printf("%8s %16.1f %16.1f\n", "double", doublePrintf, doubleToChars);
+  std::printf("%8s %16.1f %16.1f\n", "float", floatPrintf, floatToChars);
+  std::printf("checksum: %zu\n", checksum);
+  return 0;
+}
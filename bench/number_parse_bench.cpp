@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+#include "nlohmann/json.hpp"
+
+using nlohmann::detail::from_chars;
+using nlohmann::detail::to_chars;
+
+/**
+ * The number of literals of each shape.
+ */
+#define BENCH_LITERALS 1000000
+
+/**
+ * The number of timed runs, of which the best is reported.
+ */
+#define BENCH_RUNS 5
+
+/**
+ * Builds number literals of the given shape from random doubles: "shortest"
+ * as the serializer writes them, "17 digits" as printf("%.17g") does, and
+ * "40 digits" with more digits than the fast path takes, which go through
+ * the exact conversion.
+ */
+static std::vector<std::string> MakeLiterals(int shape)
+{
+  std::mt19937_64 random(42);
+  std::vector<std::string> literals;
+  literals.reserve(BENCH_LITERALS);
+  char buffer[128];
+  while (literals.size() < BENCH_LITERALS) {
+    const uint64_t bits = random();
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    if (!std::isfinite(value)) {
+      continue;
+    }
+    switch (shape) {
+    case 0:
+      *to_chars(buffer, buffer + sizeof(buffer), value) = '\0';
+      break;
+    case 1:
+      std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+      break;
+    default:
+      std::snprintf(buffer, sizeof(buffer), "%.39e", value);
+      break;
+    }
+    literals.push_back(buffer);
+  }
+  return literals;
+}
+
+/**
+ * Converts all literals with the given conversion repeatedly, and returns
+ * the best time per literal in nanoseconds. The bits of the values are
+ * accumulated into the checksum.
+ */
+template<typename Convert>
+static double Measure(const std::vector<std::string> &literals, Convert convert, uint64_t &checksum)
+{
+  double best = 1e30;
+  for (int run = 0; run < BENCH_RUNS; ++run) {
+    uint64_t bits = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (const std::string &literal : literals) {
+      const double value = convert(literal);
+      uint64_t valueBits;
+      std::memcpy(&valueBits, &value, sizeof(valueBits));
+      bits += valueBits;
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count() / literals.size());
+    checksum += bits;
+  }
+  return best;
+}
+
+
+/**
+ * Compares the conversion of number literals to doubles by the JSON lexer
+ * (from_chars) with the C library (strtod), which the lexer used before.
+ */
+int main()
+{
+  const char *shapes[] = { "shortest", "17 digits", "40 digits" };
+  uint64_t checksum = 0;
+  std::printf("%10s %16s %16s\n", "", "strtod (ns)", "from_chars (ns)");
+  for (int shape = 0; shape < 3; ++shape) {
+    const std::vector<std::string> literals = MakeLiterals(shape);
+    const double strtodTime = Measure(literals, [](const std::string &literal) {
+      return std::strtod(literal.c_str(), nullptr);
+    }, checksum);
+    const double fromCharsTime = Measure(literals, [](const std::string &literal) {
+      double value;
+      from_chars(literal.data(), literal.data() + literal.size(), value);
+      return value;
+    }, checksum);
+    std::printf("%10s %16.1f %16.1f\n", shapes[shape], strtodTime, fromCharsTime);
+  }
+  std::printf("checksum: %016llx\n", static_cast<unsigned long long>(checksum));
+  return 0;
+}
@@ -0,0 +1,118 @@
+#include <chrono>
+#include <cstdio>
+#include <future>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "calculator_engine.h"
+#include "plugin_registry.h"
+
+/**
+ * The number of operations submitted for each worker count, and the number
+ * of them in flight at once.
+ */
+#define BENCH_OPERATIONS 200000
+#define BENCH_OPERATIONS_IN_FLIGHT 4096
+
+/**
+ * The number of batches submitted for each worker count, and their size.
+ */
+#define BENCH_BATCHES 64
+#define BENCH_BATCH_ELEMENTS (1 << 18)
+
+/**
+ * Submits single operations, keeping BENCH_OPERATIONS_IN_FLIGHT futures
+ * outstanding, and returns the throughput in operations per second.
+ */
+static double MeasureOperations(CalculatorEngine &engine, double &checksum)
+{
+  std::vector<std::future<double> > inFlight;
+  inFlight.reserve(BENCH_OPERATIONS_IN_FLIGHT);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int i = 0; i < BENCH_OPERATIONS; i += BENCH_OPERATIONS_IN_FLIGHT) {
+    for (int j = i; j < i + BENCH_OPERATIONS_IN_FLIGHT && j < BENCH_OPERATIONS; ++j) {
+      inFlight.push_back(engine.submitOperation("add", j, 1));
+    }
+    for (auto &result : inFlight) {
+      checksum += result.get();
+    }
+    inFlight.clear();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return BENCH_OPERATIONS / elapsed.count();
+}
+
+/**
+ * Submits batches one after the other, and returns the throughput in
+ * elements per second.
+ */
+static double MeasureBatches(CalculatorEngine &engine, double &checksum)
+{
+  std::vector<double> operandsA(BENCH_BATCH_ELEMENTS);
+  std::vector<double> operandsB(BENCH_BATCH_ELEMENTS);
+  std::vector<double> results(BENCH_BATCH_ELEMENTS);
+  for (int i = 0; i < BENCH_BATCH_ELEMENTS; ++i) {
+    operandsA[i] = i;
+    operandsB[i] = 0.5;
+  }
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int i = 0; i < BENCH_BATCHES; ++i) {
+    if (!engine.submitOperationBatch("add", operandsA.data(), operandsB.data(),
+                                     results.data(), results.size()).get()) {
+      return 0;
+    }
+    checksum += results[i];
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(BENCH_BATCHES) * BENCH_BATCH_ELEMENTS / elapsed.count();
+}
+
+/**
+ * Measures the throughput of submitted single operations and batches for
+ * 1, 2, 4 and 8 engine workers, over the addition plugin installed by the
+ * build, along with the average worker utilization.
+ */
+int main()
+{
+  PluginRegistry::getSharedInstance().setManifestPath("");
+  CalculatorEngine engine;
+
+  // The engine reports discovery, plugin loads and worker counters, which
+  // would interleave with the measurements
+  std::ostringstream discarded;
+  std::streambuf *output = std::cout.rdbuf(discarded.rdbuf());
+  engine.start(true);
+  if (!engine.isOperationSupported("add")) {
+    std::cout.rdbuf(output);
+    std::fprintf(stderr, "The addition plugin must be installed\n");
+    return 1;
+  }
+
+  const unsigned workerCounts[] = { 1, 2, 4, 8 };
+  double checksum = 0;
+  std::printf("%8s %18s %20s %16s\n", "workers", "operations (M/s)", "batch elements (M/s)", "utilization (%)");
+  for (unsigned workerCount : workerCounts) {
+    engine.setWorkerCount(workerCount);
+    const double operations = MeasureOperations(engine, checksum);
+    const double elements = MeasureBatches(engine, checksum);
+
+    double utilization = 0;
+    std::vector<WorkerStats> stats = engine.getWorkerStats();
+    for (const WorkerStats &workerStats : stats) {
+      utilization += workerStats.getUtilization();
+    }
+    if (!stats.empty()) {
+      utilization /= stats.size();
+    }
+
+    // Stopping the engine stops the workers, so that the next submission
+    // starts the new worker count
+    engine.stop();
+    std::printf("%8u %18.2f %20.1f %16.1f\n", workerCount, operations / 1e6, elements / 1e6, 100 * utilization);
+  }
+
+  std::cout.rdbuf(output);
+  std::printf("checksum: %g\n", checksum);
+  return 0;
+}
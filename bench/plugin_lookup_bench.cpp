@@ -0,0 +1,85 @@
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+#include "plugin_index.h"
+
+/**
+ * The number of lookups timed for each case.
+ */
+#define BENCH_LOOKUPS 2000000
+
+/**
+ * The plugin entries of the original registry: type, then name.
+ */
+typedef std::map<std::string, std::map<std::string, PluginEntry*> > NestedEntries;
+
+/**
+ * The original PluginRegistry::get, which copies the inner map, and inserts
+ * unknown types into the registry.
+ */
+static PluginEntry *NestedGet(NestedEntries &entries, std::string type, std::string name)
+{
+  std::map<std::string, PluginEntry*> m = entries[type];
+  return m[name];
+}
+
+/**
+ * Times the given lookup, and returns the average time per lookup in ns.
+ */
+template<typename Lookup>
+static double TimeLookups(const std::vector<std::string> &names, Lookup lookup)
+{
+  std::size_t found = 0;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (std::size_t i = 0; i < BENCH_LOOKUPS; ++i) {
+    found += nullptr != lookup(names[i % names.size()]);
+  }
+  std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+  // Keeps the lookups from being optimized away
+  if (found > BENCH_LOOKUPS) {
+    std::printf("unreachable\n");
+  }
+  return static_cast<double>(elapsed.count()) / BENCH_LOOKUPS;
+}
+
+
+/**
+ * Compares the lookup cost of the plugin index with the nested maps it
+ * replaced, for registered and unknown names and several registry sizes.
+ */
+int main()
+{
+  const std::size_t pluginCounts[] = { 2, 16, 128 };
+
+  std::printf("%8s %8s %14s %14s\n", "plugins", "lookup", "nested (ns)", "index (ns)");
+  for (std::size_t pluginCount : pluginCounts) {
+    NestedEntries nested;
+    PluginIndex index;
+    std::vector<std::string> known;
+    std::vector<std::string> unknown;
+    for (std::size_t i = 0; i < pluginCount; ++i) {
+      const std::string name = "operation_" + std::to_string(i);
+      PluginEntry *entry = new PluginEntry("operation", name, "lib" + name + ".so", "/plugins/lib" + name + ".so");
+      index.insert(entry);
+      nested["operation"][name] = entry;
+      known.push_back(name);
+      unknown.push_back("unknown_" + std::to_string(i));
+    }
+
+    const std::vector<std::string> *cases[] = { &known, &unknown };
+    const char *caseNames[] = { "known", "unknown" };
+    for (std::size_t c = 0; c < 2; ++c) {
+      const std::vector<std::string> &names = *cases[c];
+      const double nestedTime = TimeLookups(names, [&nested](const std::string &name) {
+        return NestedGet(nested, "operation", name);
+      });
+      const double indexTime = TimeLookups(names, [&index](const std::string &name) {
+        return index.find("operation", 9, name.data(), name.size());
+      });
+      std::printf("%8zu %8s %14.1f %14.1f\n", pluginCount, caseNames[c], nestedTime, indexTime);
+    }
+  }
+  return 0;
+}
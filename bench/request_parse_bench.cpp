@@ -0,0 +1,110 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include "method_arg_reader.h"
+#include "operation.h"
+
+/**
+ * The number of requests decoded for each case.
+ */
+#define BENCH_REQUESTS 500000
+
+/**
+ * The number of allocations made so far.
+ */
+static std::atomic<unsigned long> s_allocations(0);
+
+void *operator new(std::size_t size)
+{
+  ++s_allocations;
+  void *memory = std::malloc(size ? size : 1);
+  if (nullptr == memory) {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+void operator delete(void *memory) noexcept
+{
+  std::free(memory);
+}
+
+/**
+ * The measurements of a decoding method.
+ */
+struct Measurement
+{
+  double nanoseconds;
+  double allocations;
+};
+
+/**
+ * Decodes the given request repeatedly, and returns the average time and
+ * number of allocations per request.
+ */
+template<typename Decode>
+static Measurement Measure(const char *request, Decode decode)
+{
+  const std::size_t length = std::strlen(request);
+  double checksum = 0;
+  // Warms up the buffers that are reused between requests
+  checksum += decode(request, length);
+
+  const unsigned long allocations = s_allocations.load();
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (int i = 0; i < BENCH_REQUESTS; ++i) {
+    checksum += decode(request, length);
+  }
+  std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+  // Keeps the decoding from being optimized away
+  if (checksum == -1) {
+    std::printf("unreachable\n");
+  }
+
+  Measurement measurement;
+  measurement.nanoseconds = static_cast<double>(elapsed.count()) / BENCH_REQUESTS;
+  measurement.allocations = static_cast<double>(s_allocations.load() - allocations) / BENCH_REQUESTS;
+  return measurement;
+}
+
+
+/**
+ * Compares reading the inputs of Operation::execute through MethodArgReader
+ * (SAX) with json::parse followed by member lookups, on request shapes seen
+ * by the plugins.
+ */
+int main()
+{
+  const char *requests[][2] = {
+    { "flat", "{\"operandA\": 12345.678, \"operandB\": -0.25}" },
+    { "extra members", "{\"id\": 42, \"operandA\": 1.5, \"operandB\": 2.25, "
+                       "\"comment\": \"a request comment longer than the small string buffer\"}" },
+    { "nested", "{\"operandA\": 1.5, \"options\": {\"precision\": [1, 2, 3], \"mode\": \"fast\"}, "
+                "\"operandB\": 2.25}" }
+  };
+
+  const MethodTable &methods = Operation::GetMethodTable();
+  const MethodDescriptor *execute = methods.get(methods.find("execute", 7));
+
+  std::printf("%14s %12s %12s %12s %12s\n", "request", "sax (ns)", "sax allocs", "dom (ns)", "dom allocs");
+  for (auto &request : requests) {
+    const Measurement sax = Measure(request[1], [execute](const char *message, std::size_t length) {
+      MethodArg inputs[PLUGIN_METHOD_MAX_ARGS];
+      MethodArgReader reader(execute, inputs);
+      if (MethodStatus::Ok != reader.read(message, length)) {
+        return -1.0;
+      }
+      return inputs[0].doubleValue + inputs[1].doubleValue;
+    });
+    const Measurement dom = Measure(request[1], [](const char *message, std::size_t length) {
+      nlohmann::json input = nlohmann::json::parse(message, message + length);
+      return input.at("operandA").get<double>() + input.at("operandB").get<double>();
+    });
+    std::printf("%14s %12.1f %12.1f %12.1f %12.1f\n",
+                request[0], sax.nanoseconds, sax.allocations, dom.nanoseconds, dom.allocations);
+  }
+  return 0;
+}
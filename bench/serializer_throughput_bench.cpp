@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include "nlohmann/json.hpp"
+
+using nlohmann::json;
+
+/**
+ * The number of elements of each generated document.
+ */
+#define BENCH_DOCUMENT_ELEMENTS 50000
+
+/**
+ * The number of timed runs, of which the best is reported.
+ */
+#define BENCH_RUNS 5
+
+/**
+ * Builds a plugin result document of the given shape: "results" holds
+ * objects with numbers and short strings, as returned by batch operations;
+ * "text" holds long strings that need no escaping; "escapes" holds strings
+ * with quotes, control characters and multi-byte UTF-8.
+ */
+static json MakeDocument(int shape)
+{
+  json document = json::array();
+  for (int i = 0; i < BENCH_DOCUMENT_ELEMENTS; ++i) {
+    switch (shape) {
+    case 0:
+      document.push_back({ { "id", i }, { "operation", "add" }, { "status", "ok" },
+                           { "result", i * 0.37 - 1.0 / (i + 3) }, { "elapsed", i % 977 } });
+      break;
+    case 1:
+      document.push_back("operation add completed for request " + std::to_string(i)
+                         + " on worker pool thread with plugin instance shared by all workers");
+      break;
+    default:
+      document.push_back("\"quoted\" result\tof request " + std::to_string(i)
+                         + "\n\xC3\xA9t\xC3\xA9 \xE2\x82\xAC path C:\\plugins\\add.so");
+      break;
+    }
+  }
+  return document;
+}
+
+/**
+ * Serializes the given document repeatedly, and returns the best throughput
+ * in MB of output per second.
+ */
+template<typename Dump>
+static double MeasureThroughput(const json &document, Dump dump)
+{
+  double best = 0;
+  for (int run = 0; run < BENCH_RUNS; ++run) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const std::size_t size = dump(document);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    best = std::max(best, size / 1e6 / elapsed.count());
+  }
+  return best;
+}
+
+
+/**
+ * Measures the serializer throughput on realistic plugin result documents,
+ * into a string (dump), into a stream (operator<<), and with non-ASCII
+ * characters escaped (dump with ensure_ascii).
+ */
+int main()
+{
+  const char *shapes[] = { "results", "text", "escapes" };
+  std::printf("%8s %12s %16s %16s %20s\n", "", "size (MB)", "dump (MB/s)", "stream (MB/s)", "ensure_ascii (MB/s)");
+  for (int shape = 0; shape < 3; ++shape) {
+    const json document = MakeDocument(shape);
+    const double size = document.dump().size() / 1e6;
+    const double dump = MeasureThroughput(document, [](const json &value) {
+      return value.dump().size();
+    });
+    const double stream = MeasureThroughput(document, [](const json &value) {
+      std::ostringstream output;
+      output << value;
+      return output.str().size();
+    });
+    const double ascii = MeasureThroughput(document, [](const json &value) {
+      return value.dump(-1, ' ', true).size();
+    });
+    std::printf("%8s %12.1f %16.1f %16.1f %20.1f\n", shapes[shape], size, dump, stream, ascii);
+  }
+  return 0;
+}
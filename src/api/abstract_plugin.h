@@ -2,29 +2,344 @@
 #define ABSTRACT_PLUGIN_H
 
 #include <string>
+#include "method_arg_reader.h"
+#include "method_reply_writer.h"
+#include "plugin_method.h"
 #include "nlohmann/json.hpp"
 
-using json = nlohmann::json;
+/**
+ * The JSON type of plugin messages. Messages are small objects, so objects
+ * are stored as sorted vectors (nlohmann::flat_map): one allocation per
+ * object rather than one per member.
+ */
+using json = nlohmann::flat_json;
+
+/**
+ * How the instances of a plugin may be used by concurrent threads.
+ *
+ * Only the engine workers honour this setting. The synchronous engine calls
+ * (runOperation, runOperationBatch and operation handles) always run on the
+ * single pooled instance of the plugin, so callers that make them from
+ * several threads must serialize them for plugins that are not Shared.
+ */
+enum class PluginThreadSafety : uint8_t
+{
+  /**
+   * An instance must not be used by more than one thread at a time; engine
+   * workers that run the plugin concurrently get an instance each.
+   */
+  InstancePerThread,
+
+  /**
+   * A single instance may be used by any number of threads at once.
+   */
+  Shared
+};
 
 /**
  * This class implements the basic plugin abstraction. All plugin interfaces
  * must override this base class.
+ *
+ * Plugin methods are described by the method table of the plugin interface.
+ * Callers resolve a method id once (findMethod) and then invoke the method
+ * with a flat buffer of typed arguments, which involves no allocation. JSON
+ * messages are supported on top of that, for generic callers.
  */
-class AbstractPlugin 
+class AbstractPlugin
 {
 
 public:
 
+  /**
+   * Gets the table of methods this plugin exposes.
+   *
+   * @return The method table
+   */
+  virtual const MethodTable &getMethodTable() const = 0;
+
+  /**
+   * Gets how the instances of this plugin may be used by concurrent threads.
+   * Plugins that keep no mutable state should declare themselves
+   * PluginThreadSafety::Shared, which saves concurrent callers an instance
+   * each.
+   *
+   * @return PluginThreadSafety::InstancePerThread, unless overridden
+   */
+  virtual PluginThreadSafety getThreadSafety() const
+  {
+    return PluginThreadSafety::InstancePerThread;
+  }
+
+  /**
+   * Finds the plugin method with the specified name.
+   *
+   * @param methodName The method name
+   *
+   * @return The method id, or PLUGIN_METHOD_INVALID
+   */
+  MethodId findMethod(const std::string &methodName) const
+  {
+    return getMethodTable().find(methodName.data(), methodName.size());
+  }
+
+  /**
+   * Finds the plugin method with the specified interned name.
+   *
+   * @param methodSymbol The method symbol
+   *
+   * @return The method id, or PLUGIN_METHOD_INVALID
+   */
+  MethodId findMethod(const MethodSymbol &methodSymbol) const
+  {
+    return getMethodTable().find(methodSymbol);
+  }
+
+  /**
+   * Invokes the specified plugin method using the specified typed arguments.
+   *
+   * @param methodId The id of the method to be invoked
+   * @param inputs The method inputs, in the order of the method schema
+   * @param outputs Receives the method outputs, in the order of the method
+   *                schema
+   *
+   * @return MethodStatus::Ok in success, MethodStatus::MethodNotFound if there
+   *         is no such method, or MethodStatus::Failed if the method failed
+   */
+  MethodStatus invokeMethod(MethodId methodId, const MethodArg *inputs, MethodArg *outputs)
+  {
+    const MethodDescriptor *method = getMethodTable().get(methodId);
+    if (nullptr == method) {
+      return MethodStatus::MethodNotFound;
+    }
+    return method->invoke(this, inputs, outputs) ? MethodStatus::Ok : MethodStatus::Failed;
+  }
+
+  /**
+   * Invokes the specified plugin method using the specified JSON message as
+   * input, which is read straight into typed arguments (see MethodArgReader)
+   * rather than into a JSON tree.
+   *
+   * @param methodId The id of the method to be invoked
+   * @param message A JSON message containing the method's input parameters
+   * @param length The JSON message length
+   * @param outputs Receives the method outputs, in the order of the method
+   *                schema
+   *
+   * @return MethodStatus::Ok in success, MethodStatus::MethodNotFound if there
+   *         is no such method, MethodStatus::InvalidArguments if the message
+   *         does not match the method schema, or MethodStatus::Failed if the
+   *         method failed
+   */
+  MethodStatus invokeMethod(MethodId methodId, const char *message, std::size_t length,
+                            MethodArg *outputs)
+  {
+    const MethodDescriptor *method = getMethodTable().get(methodId);
+    if (nullptr == method) {
+      return MethodStatus::MethodNotFound;
+    }
+
+    MethodArg inputs[PLUGIN_METHOD_MAX_ARGS];
+    MethodArgReader reader(method, inputs);
+    MethodStatus status = reader.read(message, length);
+    if (MethodStatus::Ok != status) {
+      return status;
+    }
+    return method->invoke(this, inputs, outputs) ? MethodStatus::Ok : MethodStatus::Failed;
+  }
+
+  /**
+   * Invokes the specified plugin method using the specified message as input.
+   * CBOR and MessagePack messages are read in place, so upstream services can
+   * pass pre-encoded payloads straight through, without a text parse or a
+   * JSON tree.
+   *
+   * @param methodId The id of the method to be invoked
+   * @param format The message format
+   * @param message A message containing the method's input parameters, which
+   *                string inputs refer to
+   * @param length The message length
+   * @param outputs Receives the method outputs, in the order of the method
+   *                schema
+   *
+   * @return MethodStatus::Ok in success, MethodStatus::MethodNotFound if there
+   *         is no such method, MethodStatus::InvalidArguments if the message
+   *         does not match the method schema, or MethodStatus::Failed if the
+   *         method failed
+   */
+  MethodStatus invokeMethod(MethodId methodId, MessageFormat format, const uint8_t *message,
+                            std::size_t length, MethodArg *outputs)
+  {
+    const MethodDescriptor *method = getMethodTable().get(methodId);
+    if (nullptr == method) {
+      return MethodStatus::MethodNotFound;
+    }
+
+    MethodArg inputs[PLUGIN_METHOD_MAX_ARGS];
+    MethodArgReader reader(method, inputs);
+    MethodStatus status = reader.read(format, message, length);
+    if (MethodStatus::Ok != status) {
+      return status;
+    }
+    return method->invoke(this, inputs, outputs) ? MethodStatus::Ok : MethodStatus::Failed;
+  }
+
+  /**
+   * Invokes the specified plugin method using the specified message as input,
+   * and replies in the same format (see MethodReplyWriter).
+   *
+   * @param methodId The id of the method to be invoked
+   * @param format The message and reply format
+   * @param message A message containing the method's input parameters
+   * @param length The message length
+   * @param reply Receives a message containing the method's outputs, if the
+   *              method succeeded
+   *
+   * @return The same as the invokeMethod above
+   */
+  MethodStatus invokeMethod(MethodId methodId, MessageFormat format, const uint8_t *message,
+                            std::size_t length, std::vector<uint8_t> *reply)
+  {
+    const MethodDescriptor *method = getMethodTable().get(methodId);
+    if (nullptr != method && method->outputCount > PLUGIN_METHOD_MAX_ARGS) {
+      return MethodStatus::InvalidArguments;
+    }
+
+    MethodArg outputs[PLUGIN_METHOD_MAX_ARGS];
+    MethodStatus status = invokeMethod(methodId, format, message, length, outputs);
+    if (MethodStatus::Ok == status) {
+      MethodReplyWriter::Write(method, outputs, format, reply);
+    }
+    return status;
+  }
+
   /**
    * Invokes the specified plugin method using the specified JSON message
    * as input.
    *
    * @param methodName The name of the method to be invoked
-   * @param input A JSON message containing the method's input parameters
+   * @param input A JSON message containing the method's input parameters;
+   *              any JSON type will do, e.g. json or ArenaJson (see
+   *              message_arena.h)
+   *
+   * @return A JSON message of the same type containing the method's output
+   *         (if any). If the method could not be invoked, the message instead
+   *         holds an "error" member with the name of the MethodStatus, e.g.
+   *         {"error": "methodNotFound"}
+   */
+  template<typename JsonType>
+  JsonType invokeMethod(const std::string &methodName, const JsonType &input)
+  {
+    const MethodDescriptor *method = getMethodTable().get(findMethod(methodName));
+    if (nullptr == method) {
+      return MakeErrorMessage<JsonType>(MethodStatus::MethodNotFound);
+    }
+    if (method->inputCount > PLUGIN_METHOD_MAX_ARGS
+        || method->outputCount > PLUGIN_METHOD_MAX_ARGS || !input.is_object()) {
+      return MakeErrorMessage<JsonType>(MethodStatus::InvalidArguments);
+    }
+
+    MethodArg inputs[PLUGIN_METHOD_MAX_ARGS];
+    for (std::size_t i = 0; i < method->inputCount; ++i) {
+      typename JsonType::const_iterator value = input.find(method->inputs[i].name);
+      if (value == input.end() || !ToMethodArg(*value, method->inputs[i].type, &inputs[i])) {
+        return MakeErrorMessage<JsonType>(MethodStatus::InvalidArguments);
+      }
+    }
+
+    MethodArg outputs[PLUGIN_METHOD_MAX_ARGS];
+    if (!method->invoke(this, inputs, outputs)) {
+      return MakeErrorMessage<JsonType>(MethodStatus::Failed);
+    }
+
+    JsonType output = JsonType::object();
+    for (std::size_t i = 0; i < method->outputCount; ++i) {
+      output[method->outputs[i].name] = FromMethodArg<JsonType>(outputs[i], method->outputs[i].type);
+    }
+    return output;
+  }
+
+private:
+
+  /**
+   * Makes the JSON reply of a method that could not be invoked.
+   *
+   * @param status The method status
+   *
+   * @return The JSON reply
+   */
+  template<typename JsonType>
+  static JsonType MakeErrorMessage(MethodStatus status)
+  {
+    JsonType output;
+    output["error"] = GetMethodStatusName(status);
+    return output;
+  }
+
+  /**
+   * Converts the given JSON value into a method argument of the given type.
+   *
+   * @param value The JSON value, which string arguments refer to
+   * @param type The argument type
+   * @param arg Receives the argument
+   *
+   * @return true in success, or false if the value has another type
+   */
+  template<typename JsonType>
+  static bool ToMethodArg(const JsonType &value, MethodArgType type, MethodArg *arg)
+  {
+    switch (type) {
+    case MethodArgType::Bool:
+      if (!value.is_boolean()) {
+        return false;
+      }
+      arg->boolValue = value.template get<bool>();
+      return true;
+    case MethodArgType::Int:
+      if (!value.is_number_integer()) {
+        return false;
+      }
+      arg->intValue = value.template get<int64_t>();
+      return true;
+    case MethodArgType::Double:
+      if (!value.is_number()) {
+        return false;
+      }
+      arg->doubleValue = value.template get<double>();
+      return true;
+    case MethodArgType::String:
+      if (!value.is_string()) {
+        return false;
+      }
+      arg->stringValue.data = value.template get_ref<const typename JsonType::string_t&>().data();
+      arg->stringValue.size = value.template get_ref<const typename JsonType::string_t&>().size();
+      return true;
+    }
+    return false;
+  }
+
+  /**
+   * Converts the given method argument of the given type into JSON.
+   *
+   * @param arg The argument
+   * @param type The argument type
    *
-   * @return A JSON message containing the method's output (if any)
+   * @return The JSON value
    */
-  virtual json invokeMethod(std::string methodName, json input) = 0;
+  template<typename JsonType>
+  static JsonType FromMethodArg(const MethodArg &arg, MethodArgType type)
+  {
+    switch (type) {
+    case MethodArgType::Bool:
+      return JsonType(arg.boolValue);
+    case MethodArgType::Int:
+      return JsonType(arg.intValue);
+    case MethodArgType::Double:
+      return JsonType(arg.doubleValue);
+    case MethodArgType::String:
+      return JsonType(typename JsonType::string_t(arg.stringValue.data, arg.stringValue.size));
+    }
+    return JsonType();
+  }
 };
 
-#endif
\ No newline at end of file
+#endif
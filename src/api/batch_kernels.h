@@ -0,0 +1,228 @@
+#ifndef BATCH_KERNELS_H
+#define BATCH_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BATCH_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+/**
+ * Compiles the annotated function for the given instruction set, regardless
+ * of the instruction set the rest of the library is compiled for.
+ */
+#define BATCH_KERNELS_TARGET(isa) __attribute__((target(isa)))
+
+/**
+ * The instruction sets batch kernels are specialized for.
+ */
+enum class InstructionSet
+{
+  Scalar,
+  SSE2,
+  AVX2,
+  AVX512
+};
+
+/**
+ * The signature of a batch kernel, which computes
+ * results[i] = operandsA[i] <op> operandsB[i] for every i < count.
+ */
+typedef void BatchKernel_t(const double *operandsA,
+                           const double *operandsB,
+                           double *results,
+                           std::size_t count);
+
+/**
+ * This class provides CPU feature detection for batch kernels.
+ */
+class CpuFeatures
+{
+
+public:
+
+  /**
+   * Detects the widest instruction set supported by both the host CPU
+   * and the operating system.
+   *
+   * @return The detected instruction set
+   */
+  static InstructionSet Detect()
+  {
+#ifdef BATCH_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) {
+      return InstructionSet::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+      return InstructionSet::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+      return InstructionSet::SSE2;
+    }
+#endif
+    return InstructionSet::Scalar;
+  }
+
+  /**
+   * Gets the name of the given instruction set.
+   *
+   * @param instructionSet The instruction set
+   *
+   * @return The instruction set name
+   */
+  static const char *GetName(InstructionSet instructionSet)
+  {
+    switch (instructionSet) {
+      case InstructionSet::SSE2:
+        return "sse2";
+      case InstructionSet::AVX2:
+        return "avx2";
+      case InstructionSet::AVX512:
+        return "avx512";
+      default:
+        return "scalar";
+    }
+  }
+};
+
+
+/**
+ * Implements batch kernels for the element-wise binary operation Op.
+ * Op must provide a static Apply overload for double and, on x86, for each
+ * vector type (__m128d, __m256d, __m512d) compiled for the matching target.
+ *
+ * Each vector kernel first processes single elements until the output is
+ * aligned to the vector width, then whole vectors, and finally the remaining
+ * tail elements. Inputs are loaded unaligned, so the three arrays do not need
+ * to share the same alignment.
+ */
+template <typename Op>
+class BatchKernels
+{
+
+public:
+
+  /**
+   * Selects the kernel for the widest instruction set of the host.
+   *
+   * @param instructionSet Receives the selected instruction set
+   *
+   * @return The selected kernel
+   */
+  static BatchKernel_t *Select(InstructionSet *instructionSet)
+  {
+    InstructionSet detected = CpuFeatures::Detect();
+    if (nullptr != instructionSet) {
+      *instructionSet = detected;
+    }
+    switch (detected) {
+#ifdef BATCH_KERNELS_X86
+      case InstructionSet::AVX512:
+        return &AVX512;
+      case InstructionSet::AVX2:
+        return &AVX2;
+      case InstructionSet::SSE2:
+        return &SSE2;
+#endif
+      default:
+        return &Scalar;
+    }
+  }
+
+  /**
+   * The portable kernel.
+   */
+  static void Scalar(const double *operandsA,
+                     const double *operandsB,
+                     double *results,
+                     std::size_t count)
+  {
+    for (std::size_t i = 0; i < count; ++i) {
+      results[i] = Op::Apply(operandsA[i], operandsB[i]);
+    }
+  }
+
+#ifdef BATCH_KERNELS_X86
+
+  /**
+   * The SSE2 kernel (2 doubles per vector).
+   */
+  BATCH_KERNELS_TARGET("sse2")
+  static void SSE2(const double *operandsA,
+                   const double *operandsB,
+                   double *results,
+                   std::size_t count)
+  {
+    std::size_t i = Peel(operandsA, operandsB, results, count, 16);
+    for (; i + 2 <= count; i += 2) {
+      __m128d a = _mm_loadu_pd(operandsA + i);
+      __m128d b = _mm_loadu_pd(operandsB + i);
+      _mm_store_pd(results + i, Op::Apply(a, b));
+    }
+    Scalar(operandsA + i, operandsB + i, results + i, count - i);
+  }
+
+  /**
+   * The AVX2 kernel (4 doubles per vector).
+   */
+  BATCH_KERNELS_TARGET("avx2")
+  static void AVX2(const double *operandsA,
+                   const double *operandsB,
+                   double *results,
+                   std::size_t count)
+  {
+    std::size_t i = Peel(operandsA, operandsB, results, count, 32);
+    for (; i + 4 <= count; i += 4) {
+      __m256d a = _mm256_loadu_pd(operandsA + i);
+      __m256d b = _mm256_loadu_pd(operandsB + i);
+      _mm256_store_pd(results + i, Op::Apply(a, b));
+    }
+    Scalar(operandsA + i, operandsB + i, results + i, count - i);
+  }
+
+  /**
+   * The AVX-512 kernel (8 doubles per vector).
+   */
+  BATCH_KERNELS_TARGET("avx512f")
+  static void AVX512(const double *operandsA,
+                     const double *operandsB,
+                     double *results,
+                     std::size_t count)
+  {
+    std::size_t i = Peel(operandsA, operandsB, results, count, 64);
+    for (; i + 8 <= count; i += 8) {
+      __m512d a = _mm512_loadu_pd(operandsA + i);
+      __m512d b = _mm512_loadu_pd(operandsB + i);
+      _mm512_store_pd(results + i, Op::Apply(a, b));
+    }
+    Scalar(operandsA + i, operandsB + i, results + i, count - i);
+  }
+
+#endif // BATCH_KERNELS_X86
+
+private:
+
+  /**
+   * Processes single elements until the output reaches the given alignment.
+   *
+   * @return The number of processed elements
+   */
+  static std::size_t Peel(const double *operandsA,
+                          const double *operandsB,
+                          double *results,
+                          std::size_t count,
+                          std::uintptr_t alignment)
+  {
+    std::size_t i = 0;
+    while (i < count && 0 != (reinterpret_cast<std::uintptr_t>(results + i) & (alignment - 1))) {
+      results[i] = Op::Apply(operandsA[i], operandsB[i]);
+      ++i;
+    }
+    return i;
+  }
+};
+
+#endif // BATCH_KERNELS_H
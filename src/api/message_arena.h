@@ -0,0 +1,412 @@
+#ifndef MESSAGE_ARENA_H
+#define MESSAGE_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <vector>
+#include "nlohmann/json.hpp"
+
+/**
+ * The size of the first block of a message arena, in bytes.
+ */
+#define MESSAGE_ARENA_BLOCK_SIZE (64 * 1024)
+
+/**
+ * A bump allocator for the JSON messages of a single request. Allocating
+ * advances a pointer within a block; freeing does nothing; and once the
+ * request is done, the whole arena is reset at once (see MessageArena::Scope).
+ *
+ * When a request needs more than the current block, further blocks are
+ * chained; the next reset coalesces them into a single block, so that an
+ * arena settles on one block large enough for its requests.
+ *
+ * The arena counts its live allocations, so that a reset never reuses memory
+ * that is still referenced: if values allocated during the scope are still
+ * alive when it ends (e.g. members added to a message created outside the
+ * scope, or a message that outlives it), the blocks are retired instead, and
+ * freed once their last allocation is released.
+ *
+ * Each thread owns an arena (GetThreadArena), which is only used by
+ * ArenaAllocator while a scope is active on that thread. Arenas are not
+ * thread-safe, and messages allocated in an arena must not leave the thread.
+ */
+class MessageArena
+{
+public:
+
+  /**
+   * Constructor.
+   *
+   * @param blockSize The size of the first block, in bytes
+   */
+  explicit MessageArena(std::size_t blockSize = MESSAGE_ARENA_BLOCK_SIZE)
+    : m_blocks(nullptr)
+    , m_cursor(nullptr)
+    , m_limit(nullptr)
+    , m_blockSize(blockSize)
+    , m_capacity(0)
+    , m_liveAllocations(0)
+    , m_depth(0)
+  {
+  }
+
+  /**
+   * Destructor.
+   */
+  ~MessageArena()
+  {
+    freeBlocks();
+    for (const Region &region : m_retiredRegions) {
+      FreeBlocks(region.blocks);
+    }
+  }
+
+  // Not copyable: allocations refer to the arena blocks
+  MessageArena(const MessageArena&) = delete;
+  MessageArena &operator=(const MessageArena&) = delete;
+
+  /**
+   * Allocates memory from the arena.
+   *
+   * @param size The number of bytes
+   * @param alignment The alignment, a power of two
+   *
+   * @return The allocated memory
+   */
+  void *allocate(std::size_t size, std::size_t alignment)
+  {
+    uintptr_t address = (reinterpret_cast<uintptr_t>(m_cursor) + alignment - 1) & ~(alignment - 1);
+    if (nullptr == m_cursor || address + size > reinterpret_cast<uintptr_t>(m_limit)) {
+      addBlock(size + alignment);
+      address = (reinterpret_cast<uintptr_t>(m_cursor) + alignment - 1) & ~(alignment - 1);
+    }
+    m_cursor = reinterpret_cast<char*>(address + size);
+    ++m_liveAllocations;
+    return reinterpret_cast<void*>(address);
+  }
+
+  /**
+   * Releases memory allocated from the arena. The memory itself is reclaimed
+   * by the next reset or, if its blocks were retired, once the last of their
+   * allocations is released.
+   *
+   * @param pointer The memory
+   *
+   * @return true if the arena owned the memory, otherwise false
+   */
+  bool release(const void *pointer)
+  {
+    if (Contains(m_blocks, pointer)) {
+      --m_liveAllocations;
+      return true;
+    }
+    for (std::size_t i = 0; i < m_retiredRegions.size(); ++i) {
+      Region &region = m_retiredRegions[i];
+      if (Contains(region.blocks, pointer)) {
+        if (0 == --region.liveAllocations) {
+          FreeBlocks(region.blocks);
+          m_retiredRegions.erase(m_retiredRegions.begin() + i);
+        }
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Checks whether the given memory was allocated from the arena, and is
+   * not reclaimed yet.
+   *
+   * @param pointer The memory
+   *
+   * @return true if the arena owns the memory, otherwise false
+   */
+  bool owns(const void *pointer) const
+  {
+    if (Contains(m_blocks, pointer)) {
+      return true;
+    }
+    for (const Region &region : m_retiredRegions) {
+      if (Contains(region.blocks, pointer)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Frees all allocations at once. If the last requests needed more than one
+   * block, the blocks are replaced by a single one of their total size.
+   * If allocations are still live, the blocks are retired rather than reused.
+   */
+  void reset()
+  {
+    if (0 != m_liveAllocations) {
+      Region region;
+      region.blocks = m_blocks;
+      region.liveAllocations = m_liveAllocations;
+      m_retiredRegions.push_back(region);
+      m_blocks = nullptr;
+      m_cursor = nullptr;
+      m_limit = nullptr;
+      m_blockSize = m_capacity;
+      m_capacity = 0;
+      m_liveAllocations = 0;
+      return;
+    }
+    if (nullptr != m_blocks && nullptr != m_blocks->next) {
+      freeBlocks();
+      m_blockSize = m_capacity;
+      m_capacity = 0;
+      addBlock(0);
+    }
+    if (nullptr != m_blocks) {
+      m_cursor = m_blocks->data();
+    }
+  }
+
+  /**
+   * Gets the total size of the arena blocks, not counting retired ones.
+   *
+   * @return The capacity, in bytes
+   */
+  std::size_t getCapacity() const
+  {
+    return m_capacity;
+  }
+
+  /**
+   * Gets the number of allocations that are not released yet, including
+   * those in retired blocks.
+   *
+   * @return The number of live allocations
+   */
+  std::size_t getLiveAllocations() const
+  {
+    std::size_t count = m_liveAllocations;
+    for (const Region &region : m_retiredRegions) {
+      count += region.liveAllocations;
+    }
+    return count;
+  }
+
+  /**
+   * Gets the arena of the calling thread.
+   *
+   * @return The thread's arena
+   */
+  static MessageArena &GetThreadArena()
+  {
+    static thread_local MessageArena arena;
+    return arena;
+  }
+
+  /**
+   * Gets the arena that allocates the messages of the calling thread.
+   *
+   * @return The thread's arena if a scope is active, otherwise nullptr
+   */
+  static MessageArena *GetCurrent()
+  {
+    MessageArena &arena = GetThreadArena();
+    return 0 == arena.m_depth ? nullptr : &arena;
+  }
+
+  /**
+   * Makes ArenaAllocator allocate from the calling thread's arena while the
+   * scope is alive, and resets the arena when the outermost scope ends:
+   *
+   *   {
+   *     MessageArena::Scope scope;
+   *     ArenaJson input = ArenaJson::parse(message);
+   *     ...
+   *   } // input is gone by now, so the arena blocks are reused
+   */
+  class Scope
+  {
+  public:
+
+    Scope()
+      : m_arena(GetThreadArena())
+    {
+      ++m_arena.m_depth;
+    }
+
+    ~Scope()
+    {
+      if (0 == --m_arena.m_depth) {
+        m_arena.reset();
+      }
+    }
+
+    Scope(const Scope&) = delete;
+    Scope &operator=(const Scope&) = delete;
+
+  private:
+
+    MessageArena &m_arena;
+  };
+
+private:
+
+  /**
+   * A memory block, followed by its data.
+   */
+  struct Block
+  {
+    Block *next;
+    std::size_t size;
+
+    char *data()
+    {
+      return reinterpret_cast<char*>(this + 1);
+    }
+
+    const char *data() const
+    {
+      return reinterpret_cast<const char*>(this + 1);
+    }
+  };
+
+  /**
+   * A chain of retired blocks, freed once all its allocations are released.
+   */
+  struct Region
+  {
+    Block *blocks;
+    std::size_t liveAllocations;
+  };
+
+  /**
+   * Checks whether the given memory lies within the given chain of blocks.
+   */
+  static bool Contains(const Block *blocks, const void *pointer)
+  {
+    const char *address = static_cast<const char*>(pointer);
+    for (const Block *block = blocks; nullptr != block; block = block->next) {
+      if (address >= block->data() && address < block->data() + block->size) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Frees the given chain of blocks.
+   */
+  static void FreeBlocks(Block *blocks)
+  {
+    while (nullptr != blocks) {
+      Block *next = blocks->next;
+      ::operator delete(blocks);
+      blocks = next;
+    }
+  }
+
+  /**
+   * Chains a new block with room for at least the given number of bytes.
+   */
+  void addBlock(std::size_t minSize)
+  {
+    std::size_t size = nullptr == m_blocks ? m_blockSize : 2 * m_blocks->size;
+    if (size < minSize) {
+      size = minSize;
+    }
+    Block *block = static_cast<Block*>(::operator new(sizeof(Block) + size));
+    block->next = m_blocks;
+    block->size = size;
+    m_blocks = block;
+    m_cursor = block->data();
+    m_limit = block->data() + size;
+    m_capacity += size;
+  }
+
+  /**
+   * Frees all current blocks.
+   */
+  void freeBlocks()
+  {
+    FreeBlocks(m_blocks);
+    m_blocks = nullptr;
+    m_cursor = nullptr;
+    m_limit = nullptr;
+  }
+
+  Block *m_blocks;
+  char *m_cursor;
+  char *m_limit;
+  std::size_t m_blockSize;
+  std::size_t m_capacity;
+  std::size_t m_liveAllocations;
+  std::vector<Region> m_retiredRegions;
+  int m_depth;
+};
+
+/**
+ * An allocator that allocates from the calling thread's message arena while
+ * a MessageArena::Scope is active, and from the heap otherwise. Memory of the
+ * arena is released to the arena rather than freed individually, whether or
+ * not a scope is active, so values may move between scoped and unscoped code
+ * on the same thread.
+ */
+template<typename T>
+class ArenaAllocator
+{
+public:
+
+  typedef T value_type;
+
+  ArenaAllocator() noexcept
+  {
+  }
+
+  template<typename U>
+  ArenaAllocator(const ArenaAllocator<U>&) noexcept
+  {
+  }
+
+  T *allocate(std::size_t count)
+  {
+    MessageArena *arena = MessageArena::GetCurrent();
+    if (nullptr == arena) {
+      return static_cast<T*>(::operator new(count * sizeof(T)));
+    }
+    return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T *pointer, std::size_t)
+  {
+    if (!MessageArena::GetThreadArena().release(pointer)) {
+      ::operator delete(pointer);
+    }
+  }
+
+  template<typename U>
+  bool operator==(const ArenaAllocator<U>&) const noexcept
+  {
+    return true;
+  }
+
+  template<typename U>
+  bool operator!=(const ArenaAllocator<U>&) const noexcept
+  {
+    return false;
+  }
+};
+
+/**
+ * A string whose characters live in the message arena.
+ */
+typedef std::basic_string<char, std::char_traits<char>, ArenaAllocator<char> > ArenaString;
+
+/**
+ * A JSON message whose values, objects, arrays and strings all live in the
+ * message arena while a MessageArena::Scope is active, so that tearing down
+ * a request is a single reset rather than one free per node.
+ */
+typedef nlohmann::basic_json<nlohmann::flat_map, std::vector, ArenaString, bool,
+                             std::int64_t, std::uint64_t, double, ArenaAllocator> ArenaJson;
+
+#endif // MESSAGE_ARENA_H
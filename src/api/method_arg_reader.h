@@ -0,0 +1,391 @@
+#ifndef METHOD_ARG_READER_H
+#define METHOD_ARG_READER_H
+
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include "plugin_method.h"
+#include "nlohmann/json.hpp"
+
+/**
+ * Reads the inputs of a plugin method from a JSON message straight into a
+ * flat buffer of typed arguments, without building a JSON tree: the message
+ * is parsed into events (see nlohmann::json_sax), and the value of every
+ * member named after a method input is bound to that input as it is read.
+ * Members the method does not know are skipped.
+ *
+ * The parser is reused across calls on the same thread, so once its buffers
+ * are large enough, reading a flat message of numbers and booleans does not
+ * allocate at all.
+ *
+ * CBOR and MessagePack messages are read item by item, in place (see
+ * nlohmann::detail::binary_cursor): their string inputs refer to the message
+ * itself, so reading them never allocates.
+ */
+class MethodArgReader
+{
+public:
+
+  typedef nlohmann::json::number_integer_t number_integer_t;
+  typedef nlohmann::json::number_unsigned_t number_unsigned_t;
+  typedef nlohmann::json::number_float_t number_float_t;
+  typedef nlohmann::json::string_t string_t;
+
+  /**
+   * Constructor.
+   *
+   * @param method The method whose inputs are read
+   * @param inputs Receives the method inputs, in the order of the method
+   *               schema; string inputs refer to the reader, so it must
+   *               outlive their use
+   */
+  MethodArgReader(const MethodDescriptor *method, MethodArg *inputs)
+    : m_method(method)
+    , m_inputs(inputs)
+    , m_depth(0)
+    , m_current(PLUGIN_METHOD_INVALID)
+    , m_bound(0)
+    , m_invalid(false)
+  {
+  }
+
+  /**
+   * Reads the method inputs from the given JSON message, which must be an
+   * object with one member per method input.
+   *
+   * @param message The JSON message characters
+   * @param length The JSON message length
+   *
+   * @return MethodStatus::Ok in success, or MethodStatus::InvalidArguments if
+   *         the message is malformed, lacks an input or has an input of
+   *         another type
+   */
+  MethodStatus read(const char *message, std::size_t length)
+  {
+    if (m_method->inputCount > PLUGIN_METHOD_MAX_ARGS) {
+      return MethodStatus::InvalidArguments;
+    }
+
+    // The adapter lives on the stack; the aliasing constructor wraps it
+    // without allocating a control block
+    nlohmann::detail::input_buffer_adapter buffer(message, length);
+    nlohmann::detail::parser<nlohmann::json> &parser = GetThreadParser();
+    parser.reset_input(nlohmann::detail::input_adapter_t(nlohmann::detail::input_adapter_t(), &buffer));
+    bool read = parser.sax_parse(this);
+    parser.reset_input(nullptr);
+
+    uint32_t all = (1u << m_method->inputCount) - 1;
+    if (!read || m_invalid || m_bound != all) {
+      return MethodStatus::InvalidArguments;
+    }
+    return MethodStatus::Ok;
+  }
+
+  /**
+   * Reads the method inputs from the given message, which must be a map
+   * (object) with one member per method input.
+   *
+   * @param format The message format
+   * @param message The message bytes, which string inputs of binary messages
+   *                refer to
+   * @param length The message length
+   *
+   * @return MethodStatus::Ok in success, or MethodStatus::InvalidArguments if
+   *         the message is malformed, lacks an input or has an input of
+   *         another type
+   */
+  MethodStatus read(MessageFormat format, const uint8_t *message, std::size_t length)
+  {
+    if (MessageFormat::Json == format) {
+      return read(reinterpret_cast<const char*>(message), length);
+    }
+    if (m_method->inputCount > PLUGIN_METHOD_MAX_ARGS) {
+      return MethodStatus::InvalidArguments;
+    }
+
+    typedef nlohmann::detail::binary_cursor cursor_t;
+    cursor_t cursor(MessageFormat::Cbor == format
+                      ? nlohmann::detail::input_format_t::cbor
+                      : nlohmann::detail::input_format_t::msgpack,
+                    message, message + length);
+    cursor_t::item object;
+    if (!cursor.read(object) || cursor_t::item_type::object != object.type) {
+      return MethodStatus::InvalidArguments;
+    }
+
+    // Values are bound through the SAX events, as members of the message
+    m_depth = 1;
+    for (std::size_t i = 0; ; ++i) {
+      if (cursor_t::indefinite_size == object.size ? cursor.read_break() : i == object.size) {
+        break;
+      }
+      cursor_t::item name;
+      if (!cursor.read(name) || cursor_t::item_type::string != name.type) {
+        return MethodStatus::InvalidArguments;
+      }
+      m_current = findInput(reinterpret_cast<const char*>(name.data), name.size);
+      if (PLUGIN_METHOD_INVALID == m_current) {
+        if (!cursor.skip()) {
+          return MethodStatus::InvalidArguments;
+        }
+        continue;
+      }
+      cursor_t::item value;
+      if (!cursor.read(value) || !bindItem(value)) {
+        return MethodStatus::InvalidArguments;
+      }
+    }
+
+    uint32_t all = (1u << m_method->inputCount) - 1;
+    if (!cursor.at_end() || m_invalid || m_bound != all) {
+      return MethodStatus::InvalidArguments;
+    }
+    return MethodStatus::Ok;
+  }
+
+  // SAX events, see nlohmann::json_sax
+
+  bool null()
+  {
+    return skipValue();
+  }
+
+  bool boolean(bool value)
+  {
+    if (!isBinding()) {
+      return skipValue();
+    }
+    if (MethodArgType::Bool != currentType()) {
+      return reject();
+    }
+    m_inputs[m_current].boolValue = value;
+    return bind();
+  }
+
+  bool number_integer(number_integer_t value)
+  {
+    if (!isBinding()) {
+      return skipValue();
+    }
+    if (MethodArgType::Int == currentType()) {
+      m_inputs[m_current].intValue = value;
+      return bind();
+    }
+    if (MethodArgType::Double == currentType()) {
+      m_inputs[m_current].doubleValue = static_cast<double>(value);
+      return bind();
+    }
+    return reject();
+  }
+
+  bool number_unsigned(number_unsigned_t value)
+  {
+    if (!isBinding()) {
+      return skipValue();
+    }
+    if (MethodArgType::Int == currentType()
+        && value <= static_cast<number_unsigned_t>(std::numeric_limits<int64_t>::max())) {
+      m_inputs[m_current].intValue = static_cast<int64_t>(value);
+      return bind();
+    }
+    if (MethodArgType::Double == currentType()) {
+      m_inputs[m_current].doubleValue = static_cast<double>(value);
+      return bind();
+    }
+    return reject();
+  }
+
+  bool number_float(number_float_t value, const string_t &)
+  {
+    if (!isBinding()) {
+      return skipValue();
+    }
+    if (MethodArgType::Double != currentType()) {
+      return reject();
+    }
+    m_inputs[m_current].doubleValue = value;
+    return bind();
+  }
+
+  bool string(string_t &value)
+  {
+    if (!isBinding()) {
+      return skipValue();
+    }
+    if (MethodArgType::String != currentType()) {
+      return reject();
+    }
+    m_strings[m_current].swap(value);
+    m_inputs[m_current].stringValue.data = m_strings[m_current].data();
+    m_inputs[m_current].stringValue.size = m_strings[m_current].size();
+    return bind();
+  }
+
+  bool start_object(std::size_t)
+  {
+    // Only the message itself, and the members the method does not know,
+    // may be objects
+    if (isBinding()) {
+      return reject();
+    }
+    ++m_depth;
+    return true;
+  }
+
+  bool key(string_t &name)
+  {
+    if (1 == m_depth) {
+      m_current = findInput(name.data(), name.size());
+    }
+    return true;
+  }
+
+  bool end_object()
+  {
+    --m_depth;
+    m_current = PLUGIN_METHOD_INVALID;
+    return true;
+  }
+
+  bool start_array(std::size_t)
+  {
+    if (0 == m_depth || isBinding()) {
+      return reject();
+    }
+    ++m_depth;
+    return true;
+  }
+
+  bool end_array()
+  {
+    --m_depth;
+    m_current = PLUGIN_METHOD_INVALID;
+    return true;
+  }
+
+  bool parse_error(std::size_t, const std::string &, const nlohmann::detail::exception &)
+  {
+    return reject();
+  }
+
+private:
+
+  /**
+   * Gets the parser reused by all readers of the calling thread.
+   */
+  static nlohmann::detail::parser<nlohmann::json> &GetThreadParser()
+  {
+    static thread_local nlohmann::detail::parser<nlohmann::json> parser(nullptr, nullptr, false);
+    return parser;
+  }
+
+  /**
+   * Finds the method input with the given name.
+   *
+   * @return The input index, or PLUGIN_METHOD_INVALID
+   */
+  MethodId findInput(const char *name, std::size_t length) const
+  {
+    for (std::size_t i = 0; i < m_method->inputCount; ++i) {
+      const char *inputName = m_method->inputs[i].name;
+      if (std::strlen(inputName) == length && 0 == std::memcmp(inputName, name, length)) {
+        return static_cast<MethodId>(i);
+      }
+    }
+    return PLUGIN_METHOD_INVALID;
+  }
+
+  /**
+   * Binds the given item of a binary message to the current method input.
+   * String inputs refer to the message; containers are never inputs.
+   */
+  bool bindItem(const nlohmann::detail::binary_cursor::item &value)
+  {
+    typedef nlohmann::detail::binary_cursor::item_type item_type;
+    switch (value.type) {
+    case item_type::boolean:
+      return boolean(value.boolean);
+    case item_type::number_integer:
+      return number_integer(value.number_integer);
+    case item_type::number_unsigned:
+      return number_unsigned(value.number_unsigned);
+    case item_type::number_float:
+      return number_float(value.number_float, string_t());
+    case item_type::string:
+      if (MethodArgType::String != currentType()) {
+        return reject();
+      }
+      m_inputs[m_current].stringValue.data = reinterpret_cast<const char*>(value.data);
+      m_inputs[m_current].stringValue.size = value.size;
+      return bind();
+    default:
+      return reject();
+    }
+  }
+
+  /**
+   * Checks whether the next value is bound to a method input.
+   */
+  bool isBinding() const
+  {
+    return 1 == m_depth && PLUGIN_METHOD_INVALID != m_current;
+  }
+
+  /**
+   * Gets the type of the method input the next value is bound to.
+   */
+  MethodArgType currentType() const
+  {
+    return m_method->inputs[m_current].type;
+  }
+
+  /**
+   * Marks the current method input as bound.
+   */
+  bool bind()
+  {
+    m_bound |= 1u << m_current;
+    m_current = PLUGIN_METHOD_INVALID;
+    return true;
+  }
+
+  /**
+   * Skips a value that is not bound to a method input. The message itself
+   * must be an object, not a plain value.
+   */
+  bool skipValue()
+  {
+    if (0 == m_depth) {
+      return reject();
+    }
+    if (1 == m_depth) {
+      m_current = PLUGIN_METHOD_INVALID;
+    }
+    return true;
+  }
+
+  /**
+   * Rejects the message.
+   */
+  bool reject()
+  {
+    m_invalid = true;
+    return false;
+  }
+
+  const MethodDescriptor *m_method;
+  MethodArg *m_inputs;
+  int m_depth;
+  MethodId m_current;
+  uint32_t m_bound;
+  bool m_invalid;
+
+  /**
+   * The storage of string inputs.
+   */
+  std::string m_strings[PLUGIN_METHOD_MAX_ARGS];
+};
+
+#endif // METHOD_ARG_READER_H
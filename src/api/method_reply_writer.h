@@ -0,0 +1,237 @@
+#ifndef METHOD_REPLY_WRITER_H
+#define METHOD_REPLY_WRITER_H
+
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <vector>
+#include "plugin_method.h"
+#include "nlohmann/json.hpp"
+
+/**
+ * Writes the outputs of a plugin method as a reply message: a map (object)
+ * with one member per method output, named after the output. CBOR and
+ * MessagePack replies are encoded straight from the typed outputs, without
+ * building a JSON tree.
+ */
+class MethodReplyWriter
+{
+public:
+
+  /**
+   * Writes the reply of the given method.
+   *
+   * @param method The method
+   * @param outputs The method outputs, in the order of the method schema
+   * @param format The reply format
+   * @param reply Receives the reply, which replaces its contents
+   */
+  static void Write(const MethodDescriptor *method, const MethodArg *outputs,
+                    MessageFormat format, std::vector<uint8_t> *reply)
+  {
+    reply->clear();
+    switch (format) {
+    case MessageFormat::Json:
+      WriteJson(method, outputs, reply);
+      break;
+    case MessageFormat::Cbor:
+      WriteCborHead(5, method->outputCount, reply);
+      for (std::size_t i = 0; i < method->outputCount; ++i) {
+        const char *name = method->outputs[i].name;
+        WriteCborHead(3, std::strlen(name), reply);
+        reply->insert(reply->end(), name, name + std::strlen(name));
+        WriteCborArg(outputs[i], method->outputs[i].type, reply);
+      }
+      break;
+    case MessageFormat::MessagePack:
+      WriteMsgpackMapHead(method->outputCount, reply);
+      for (std::size_t i = 0; i < method->outputCount; ++i) {
+        const char *name = method->outputs[i].name;
+        WriteMsgpackString(name, std::strlen(name), reply);
+        WriteMsgpackArg(outputs[i], method->outputs[i].type, reply);
+      }
+      break;
+    }
+  }
+
+private:
+
+  /**
+   * Writes the JSON text of the reply.
+   */
+  static void WriteJson(const MethodDescriptor *method, const MethodArg *outputs,
+                        std::vector<uint8_t> *reply)
+  {
+    nlohmann::flat_json output = nlohmann::flat_json::object();
+    for (std::size_t i = 0; i < method->outputCount; ++i) {
+      const MethodArg &arg = outputs[i];
+      nlohmann::flat_json &value = output[method->outputs[i].name];
+      switch (method->outputs[i].type) {
+      case MethodArgType::Bool:
+        value = arg.boolValue;
+        break;
+      case MethodArgType::Int:
+        value = arg.intValue;
+        break;
+      case MethodArgType::Double:
+        value = arg.doubleValue;
+        break;
+      case MethodArgType::String:
+        value = std::string(arg.stringValue.data, arg.stringValue.size);
+        break;
+      }
+    }
+    std::string text = output.dump();
+    reply->assign(text.begin(), text.end());
+  }
+
+  /**
+   * Writes the given number in big-endian order, on the given number of bytes.
+   */
+  static void WriteBigEndian(uint64_t value, std::size_t size, std::vector<uint8_t> *reply)
+  {
+    for (std::size_t i = size; i > 0; --i) {
+      reply->push_back(static_cast<uint8_t>(value >> (8 * (i - 1))));
+    }
+  }
+
+  /**
+   * Writes the given double as its IEEE 754 bits, in big-endian order.
+   */
+  static void WriteDouble(double value, std::vector<uint8_t> *reply)
+  {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    WriteBigEndian(bits, sizeof(bits), reply);
+  }
+
+  /**
+   * Writes the initial byte of a CBOR item of the given major type, followed
+   * by its argument (its value, length or count) in the shortest form.
+   */
+  static void WriteCborHead(uint8_t majorType, uint64_t argument, std::vector<uint8_t> *reply)
+  {
+    const uint8_t initialByte = static_cast<uint8_t>(majorType << 5);
+    if (argument < 24) {
+      reply->push_back(static_cast<uint8_t>(initialByte | argument));
+    } else if (argument <= 0xff) {
+      reply->push_back(initialByte | 24);
+      WriteBigEndian(argument, 1, reply);
+    } else if (argument <= 0xffff) {
+      reply->push_back(initialByte | 25);
+      WriteBigEndian(argument, 2, reply);
+    } else if (argument <= 0xffffffff) {
+      reply->push_back(initialByte | 26);
+      WriteBigEndian(argument, 4, reply);
+    } else {
+      reply->push_back(initialByte | 27);
+      WriteBigEndian(argument, 8, reply);
+    }
+  }
+
+  /**
+   * Writes the given method argument as a CBOR item.
+   */
+  static void WriteCborArg(const MethodArg &arg, MethodArgType type, std::vector<uint8_t> *reply)
+  {
+    switch (type) {
+    case MethodArgType::Bool:
+      reply->push_back(arg.boolValue ? 0xf5 : 0xf4);
+      break;
+    case MethodArgType::Int:
+      if (arg.intValue >= 0) {
+        WriteCborHead(0, static_cast<uint64_t>(arg.intValue), reply);
+      } else {
+        // Negative integers are encoded as -1 - n
+        WriteCborHead(1, static_cast<uint64_t>(-1 - arg.intValue), reply);
+      }
+      break;
+    case MethodArgType::Double:
+      reply->push_back(0xfb);
+      WriteDouble(arg.doubleValue, reply);
+      break;
+    case MethodArgType::String:
+      WriteCborHead(3, arg.stringValue.size, reply);
+      reply->insert(reply->end(), arg.stringValue.data, arg.stringValue.data + arg.stringValue.size);
+      break;
+    }
+  }
+
+  /**
+   * Writes the header of a MessagePack map of the given size.
+   */
+  static void WriteMsgpackMapHead(std::size_t size, std::vector<uint8_t> *reply)
+  {
+    if (size <= 15) {
+      reply->push_back(static_cast<uint8_t>(0x80 | size));
+    } else if (size <= 0xffff) {
+      reply->push_back(0xde);
+      WriteBigEndian(size, 2, reply);
+    } else {
+      reply->push_back(0xdf);
+      WriteBigEndian(size, 4, reply);
+    }
+  }
+
+  /**
+   * Writes the given string as a MessagePack item.
+   */
+  static void WriteMsgpackString(const char *data, std::size_t size, std::vector<uint8_t> *reply)
+  {
+    if (size <= 31) {
+      reply->push_back(static_cast<uint8_t>(0xa0 | size));
+    } else if (size <= 0xff) {
+      reply->push_back(0xd9);
+      WriteBigEndian(size, 1, reply);
+    } else if (size <= 0xffff) {
+      reply->push_back(0xda);
+      WriteBigEndian(size, 2, reply);
+    } else {
+      reply->push_back(0xdb);
+      WriteBigEndian(size, 4, reply);
+    }
+    reply->insert(reply->end(), data, data + size);
+  }
+
+  /**
+   * Writes the given method argument as a MessagePack item, integers in the
+   * shortest form.
+   */
+  static void WriteMsgpackArg(const MethodArg &arg, MethodArgType type, std::vector<uint8_t> *reply)
+  {
+    switch (type) {
+    case MethodArgType::Bool:
+      reply->push_back(arg.boolValue ? 0xc3 : 0xc2);
+      break;
+    case MethodArgType::Int:
+    {
+      const int64_t value = arg.intValue;
+      if (value >= -32 && value <= 127) {
+        // positive or negative fixint
+        reply->push_back(static_cast<uint8_t>(value));
+      } else if (value > 0) {
+        const uint64_t number = static_cast<uint64_t>(value);
+        const std::size_t size = number <= 0xff ? 1 : number <= 0xffff ? 2 : number <= 0xffffffff ? 4 : 8;
+        reply->push_back(static_cast<uint8_t>(size == 1 ? 0xcc : size == 2 ? 0xcd : size == 4 ? 0xce : 0xcf));
+        WriteBigEndian(number, size, reply);
+      } else {
+        const std::size_t size = value >= std::numeric_limits<int8_t>::min() ? 1
+          : value >= std::numeric_limits<int16_t>::min() ? 2
+          : value >= std::numeric_limits<int32_t>::min() ? 4 : 8;
+        reply->push_back(static_cast<uint8_t>(size == 1 ? 0xd0 : size == 2 ? 0xd1 : size == 4 ? 0xd2 : 0xd3));
+        WriteBigEndian(static_cast<uint64_t>(value), size, reply);
+      }
+      break;
+    }
+    case MethodArgType::Double:
+      reply->push_back(0xcb);
+      WriteDouble(arg.doubleValue, reply);
+      break;
+    case MethodArgType::String:
+      WriteMsgpackString(arg.stringValue.data, arg.stringValue.size, reply);
+      break;
+    }
+  }
+};
+
+#endif // METHOD_REPLY_WRITER_H
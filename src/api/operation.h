@@ -1,8 +1,15 @@
 #ifndef OPERATION_H
 #define OPERATION_H
 
+#include <cstddef>
 #include <string>
 #include "abstract_plugin.h"
+#include "plugin_metadata.h"
+
+/**
+ * The plugin type that corresponds to this interface.
+ */
+#define OPERATION_PLUGIN_TYPE "operation"
 
 /**
  * This abstract class defines the interface of the Operation plugin.
@@ -32,25 +39,82 @@ public:
   virtual double execute(double operandA, double operandB) = 0;
 
   /**
-   * Invokes the specified plugin method using the specified JSON message
-   * as input.
-   *
-   * @param methodName The name of the method to be invoked
-   * @param input A JSON message containing the method's input parameters
+   * Executes this operation on a batch of operand pairs, i.e. computes
+   * results[i] = execute(operandsA[i], operandsB[i]) for every i < count.
+   * The default implementation falls back to the scalar execute method;
+   * plugins should override it with a loop the compiler can vectorize.
    *
-   * @return A JSON message containing the method's output (if any)
+   * @param operandsA The first operands
+   * @param operandsB The second operands
+   * @param results The output buffer, which receives count results
+   * @param count The number of operand pairs
    */
-  virtual json invokeMethod(std::string methodName, json input) final
+  virtual void executeBatch(const double *operandsA,
+                            const double *operandsB,
+                            double *results,
+                            std::size_t count)
   {
-    if ("execute" == methodName) {
-      double operandA = input["operandA"].get<double>();
-      double operandB = input["operandB"].get<double>();
-      json output;
-      double result = execute(operandA, operandB);
-      output["result"] = result;
-      return output;
+    for (std::size_t i = 0; i < count; ++i) {
+      results[i] = execute(operandsA[i], operandsB[i]);
     }
   }
+
+  /**
+   * Gets the name of the instruction set executeBatch was specialized for
+   * on this host (e.g. "avx2").
+   *
+   * @return The instruction set name
+   */
+  virtual const char *getInstructionSet() const
+  {
+    return "scalar";
+  }
+
+  /**
+   * Gets the table of methods every Operation plugin exposes:
+   *
+   *   execute(operandA: double, operandB: double) -> (result: double)
+   *
+   * @return The method table
+   */
+  virtual const MethodTable &getMethodTable() const override
+  {
+    return GetMethodTable();
+  }
+
+  /**
+   * Gets the table of methods every Operation plugin exposes, which is
+   * built once.
+   *
+   * @return The method table
+   */
+  static const MethodTable &GetMethodTable()
+  {
+    static const MethodParam executeInputs[] = {
+      { "operandA", MethodArgType::Double },
+      { "operandB", MethodArgType::Double }
+    };
+    static const MethodParam executeOutputs[] = {
+      { "result", MethodArgType::Double }
+    };
+    static const MethodDescriptor methods[] = {
+      { "execute", executeInputs, 2, executeOutputs, 1, &InvokeExecute }
+    };
+    static const MethodTable methodTable(methods, sizeof(methods) / sizeof(methods[0]));
+    return methodTable;
+  }
+
+private:
+
+  /**
+   * Invokes the execute method with typed arguments.
+   */
+  static bool InvokeExecute(AbstractPlugin *plugin, const MethodArg *inputs, MethodArg *outputs)
+  {
+    Operation *operation = static_cast<Operation*>(plugin);
+    outputs[0].doubleValue = operation->execute(inputs[0].doubleValue, inputs[1].doubleValue);
+    return true;
+  }
 };
 
 
@@ -62,7 +126,7 @@ public:
 extern "C"
 const char *getType()
 {
-  return "operation";
+  return OPERATION_PLUGIN_TYPE;
 }
 
 #endif // OPERATION_H
@@ -0,0 +1,75 @@
+#ifndef PLUGIN_METADATA_H
+#define PLUGIN_METADATA_H
+
+#include <stdint.h>
+
+/**
+ * The name of the ELF section that holds the plugin metadata.
+ */
+#define PLUGIN_METADATA_SECTION "plugin_metadata"
+
+/**
+ * The magic number that identifies a plugin metadata record ("PLMD").
+ */
+#define PLUGIN_METADATA_MAGIC 0x444d4c50u
+
+/**
+ * The layout version of the plugin metadata record.
+ */
+#define PLUGIN_METADATA_ABI_VERSION 1u
+
+/**
+ * The maximum length of each metadata string, including the terminator.
+ */
+#define PLUGIN_METADATA_STRING_SIZE 64
+
+/**
+ * This structure describes a plugin without having to load it.
+ * It is stored in a dedicated ELF section of the plugin library, which the
+ * plugin registry reads straight from the file during discovery.
+ */
+struct PluginMetadata
+{
+  /**
+   * Must be PLUGIN_METADATA_MAGIC.
+   */
+  uint32_t magic;
+
+  /**
+   * Must be PLUGIN_METADATA_ABI_VERSION.
+   */
+  uint32_t abiVersion;
+
+  /**
+   * The plugin type (null-terminated).
+   */
+  char type[PLUGIN_METADATA_STRING_SIZE];
+
+  /**
+   * The plugin name (null-terminated).
+   */
+  char name[PLUGIN_METADATA_STRING_SIZE];
+
+  /**
+   * The plugin version (null-terminated).
+   */
+  char version[PLUGIN_METADATA_STRING_SIZE];
+};
+
+/**
+ * Declares the metadata of a plugin. Must be used exactly once per plugin
+ * library, e.g.:
+ *
+ *   PLUGIN_METADATA("operation", "add", "1.0.0")
+ *
+ * Plugins that do not declare their metadata are still discovered, by
+ * loading them and calling their getType/getName functions.
+ */
+#define PLUGIN_METADATA(type, name, version)                                 \
+  extern "C" __attribute__((section(PLUGIN_METADATA_SECTION), used,          \
+                            visibility("default")))                          \
+  const PluginMetadata pluginMetadata = {                                    \
+    PLUGIN_METADATA_MAGIC, PLUGIN_METADATA_ABI_VERSION, type, name, version  \
+  };
+
+#endif // PLUGIN_METADATA_H
@@ -0,0 +1,427 @@
+#ifndef PLUGIN_METHOD_H
+#define PLUGIN_METHOD_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+
+class AbstractPlugin;
+
+/**
+ * Identifies a plugin method within the method table of its plugin type.
+ * Method ids are resolved once (see AbstractPlugin::findMethod) and stay
+ * valid for all plugins of the same type.
+ */
+typedef int MethodId;
+
+/**
+ * The method id that denotes a method that does not exist.
+ */
+#define PLUGIN_METHOD_INVALID (-1)
+
+/**
+ * The maximum number of inputs, or outputs, of a plugin method.
+ */
+#define PLUGIN_METHOD_MAX_ARGS 8
+
+/**
+ * The number of displacements tried per bucket when building the perfect
+ * hash table of a method table.
+ */
+#define PLUGIN_METHOD_MAX_DISPLACEMENT 0xffffu
+
+/**
+ * The outcome of invoking a plugin method.
+ */
+enum class MethodStatus : uint8_t
+{
+  Ok,
+  MethodNotFound,
+  InvalidArguments,
+  Failed
+};
+
+/**
+ * Gets the name of the given method status, as reported in the "error"
+ * member of JSON replies (e.g. "methodNotFound").
+ *
+ * @param status The method status
+ *
+ * @return The status name
+ */
+inline const char *GetMethodStatusName(MethodStatus status)
+{
+  switch (status) {
+  case MethodStatus::Ok:
+    return "ok";
+  case MethodStatus::MethodNotFound:
+    return "methodNotFound";
+  case MethodStatus::InvalidArguments:
+    return "invalidArguments";
+  case MethodStatus::Failed:
+    return "failed";
+  }
+  return "failed";
+}
+
+/**
+ * The encoding of a plugin method message. Binary messages (CBOR, RFC 7049,
+ * and MessagePack) are read in place, without building a JSON tree.
+ */
+enum class MessageFormat : uint8_t
+{
+  Json,
+  Cbor,
+  MessagePack
+};
+
+/**
+ * Hashes the given method name (FNV-1a). Usable in constant expressions, so
+ * that the hash of a method name literal is computed at compile time.
+ *
+ * @param name The method name characters
+ * @param length The method name length
+ * @param hash The hash of the preceding characters
+ *
+ * @return The method name hash
+ */
+constexpr uint32_t HashMethodName(const char *name, std::size_t length, uint32_t hash = 2166136261u)
+{
+  return 0 == length
+    ? hash
+    : HashMethodName(name + 1, length - 1, (hash ^ static_cast<unsigned char>(*name)) * 16777619u);
+}
+
+/**
+ * Gets the length of the given null-terminated string at compile time.
+ */
+constexpr std::size_t MethodNameLength(const char *name, std::size_t length = 0)
+{
+  return '\0' == name[length] ? length : MethodNameLength(name, length + 1);
+}
+
+/**
+ * An interned plugin method name: the name together with its precomputed
+ * hash. Symbols of name literals are built at compile time, e.g.
+ *
+ *   constexpr MethodSymbol executeSymbol("execute");
+ *
+ * so that looking them up in a method table costs a single probe.
+ */
+struct MethodSymbol
+{
+  /**
+   * Constructor.
+   *
+   * @param name The method name (null-terminated), which must outlive the symbol
+   */
+  explicit constexpr MethodSymbol(const char *name)
+    : name(name)
+    , length(MethodNameLength(name))
+    , hash(HashMethodName(name, MethodNameLength(name)))
+  {
+  }
+
+  /**
+   * Constructor.
+   *
+   * @param name The method name characters, which must outlive the symbol
+   * @param length The method name length
+   */
+  constexpr MethodSymbol(const char *name, std::size_t length)
+    : name(name)
+    , length(length)
+    , hash(HashMethodName(name, length))
+  {
+  }
+
+  const char *name;
+  std::size_t length;
+  uint32_t hash;
+};
+
+/**
+ * The type of a plugin method argument.
+ */
+enum class MethodArgType : uint8_t
+{
+  Bool,
+  Int,
+  Double,
+  String
+};
+
+/**
+ * A single plugin method argument, whose type is given by the method schema.
+ * Arguments are passed as a flat buffer, in schema order.
+ */
+union MethodArg
+{
+  bool boolValue;
+  int64_t intValue;
+  double doubleValue;
+
+  /**
+   * A string argument, which is not copied: input strings must outlive the
+   * call, while output strings are owned by the plugin and stay valid until
+   * its next call.
+   */
+  struct
+  {
+    const char *data;
+    std::size_t size;
+  } stringValue;
+};
+
+/**
+ * Describes a single input or output of a plugin method.
+ */
+struct MethodParam
+{
+  /**
+   * The argument name, as used by JSON messages.
+   */
+  const char *name;
+
+  /**
+   * The argument type.
+   */
+  MethodArgType type;
+};
+
+/**
+ * Invokes a plugin method on the given plugin, which must be of the plugin
+ * type the method belongs to.
+ *
+ * @param plugin The plugin instance
+ * @param inputs The method inputs, in schema order
+ * @param outputs Receives the method outputs, in schema order
+ *
+ * @return true in success, otherwise false
+ */
+typedef bool MethodInvoker_t(AbstractPlugin *plugin, const MethodArg *inputs, MethodArg *outputs);
+
+/**
+ * Describes a plugin method: its name, its argument schema and the function
+ * that invokes it.
+ */
+struct MethodDescriptor
+{
+  const char *name;
+  const MethodParam *inputs;
+  std::size_t inputCount;
+  const MethodParam *outputs;
+  std::size_t outputCount;
+  MethodInvoker_t *invoke;
+};
+
+/**
+ * The table of methods a plugin type exposes. Each plugin interface defines
+ * its table once; a method id is the index of the method within the table.
+ *
+ * Names are resolved through a perfect hash table, which is built along with
+ * the method table (hash and displace): the name hash selects a bucket, and
+ * the displacement of the bucket, chosen so that no two methods collide,
+ * selects the slot. Whatever the number of methods, a lookup costs a single
+ * probe and a single name comparison.
+ */
+class MethodTable
+{
+public:
+
+  /**
+   * Constructor.
+   *
+   * @param methods The method descriptors, which must outlive the table and
+   *                must have distinct names
+   * @param count The number of methods
+   */
+  MethodTable(const MethodDescriptor *methods, std::size_t count)
+    : m_methods(methods)
+    , m_count(count)
+  {
+    // Two slots per method and two methods per bucket, on average
+    std::size_t slotCount = 1;
+    while (slotCount < 2 * count) {
+      slotCount *= 2;
+    }
+    std::size_t bucketCount = std::max<std::size_t>(1, slotCount / 4);
+    m_slotMask = static_cast<uint32_t>(slotCount - 1);
+    m_bucketMask = static_cast<uint32_t>(bucketCount - 1);
+    m_slots.assign(slotCount, PLUGIN_METHOD_INVALID);
+    m_displacements.assign(bucketCount, 0);
+
+    std::vector<uint32_t> hashes(count);
+    std::vector<std::vector<MethodId> > buckets(bucketCount);
+    m_nameLengths.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+      m_nameLengths[i] = std::strlen(methods[i].name);
+      hashes[i] = HashMethodName(methods[i].name, m_nameLengths[i]);
+      buckets[hashes[i] & m_bucketMask].push_back(static_cast<MethodId>(i));
+    }
+
+    // Place the largest buckets first, while most slots are still free
+    std::vector<uint32_t> order(bucketCount);
+    for (std::size_t i = 0; i < bucketCount; ++i) {
+      order[i] = static_cast<uint32_t>(i);
+    }
+    std::sort(order.begin(), order.end(), [&buckets](uint32_t a, uint32_t b) {
+      return buckets[a].size() > buckets[b].size();
+    });
+
+    std::vector<std::size_t> slots;
+    for (auto bucket : order) {
+      const std::vector<MethodId> &members = buckets[bucket];
+      if (members.empty()) {
+        break;
+      }
+      for (uint32_t displacement = 0; ; ++displacement) {
+        if (displacement > PLUGIN_METHOD_MAX_DISPLACEMENT) {
+          // Only happens if two names share a hash; look names up linearly
+          m_slots.clear();
+          return;
+        }
+        slots.clear();
+        for (auto methodId : members) {
+          std::size_t slot = slotOf(hashes[methodId], displacement);
+          if (PLUGIN_METHOD_INVALID != m_slots[slot]
+              || slots.end() != std::find(slots.begin(), slots.end(), slot)) {
+            break;
+          }
+          slots.push_back(slot);
+        }
+        if (slots.size() == members.size()) {
+          for (std::size_t i = 0; i < members.size(); ++i) {
+            m_slots[slots[i]] = members[i];
+          }
+          m_displacements[bucket] = displacement;
+          break;
+        }
+      }
+    }
+  }
+
+  /**
+   * Finds the method with the specified name.
+   *
+   * @param symbol The method symbol
+   *
+   * @return The method id, or PLUGIN_METHOD_INVALID
+   */
+  MethodId find(const MethodSymbol &symbol) const
+  {
+    if (m_slots.empty()) {
+      for (std::size_t i = 0; i < m_count; ++i) {
+        if (hasName(static_cast<MethodId>(i), symbol)) {
+          return static_cast<MethodId>(i);
+        }
+      }
+      return PLUGIN_METHOD_INVALID;
+    }
+
+    MethodId methodId = m_slots[slotOf(symbol.hash, m_displacements[symbol.hash & m_bucketMask])];
+    if (PLUGIN_METHOD_INVALID == methodId || !hasName(methodId, symbol)) {
+      return PLUGIN_METHOD_INVALID;
+    }
+    return methodId;
+  }
+
+  /**
+   * Finds the method with the specified name.
+   *
+   * @param name The method name characters
+   * @param length The method name length
+   *
+   * @return The method id, or PLUGIN_METHOD_INVALID
+   */
+  MethodId find(const char *name, std::size_t length) const
+  {
+    return find(MethodSymbol(name, length));
+  }
+
+  /**
+   * Gets the descriptor of the specified method.
+   *
+   * @param methodId The method id
+   *
+   * @return The method descriptor, or nullptr if there is no such method
+   */
+  const MethodDescriptor *get(MethodId methodId) const
+  {
+    if (methodId < 0 || static_cast<std::size_t>(methodId) >= m_count) {
+      return nullptr;
+    }
+    return &m_methods[methodId];
+  }
+
+  /**
+   * Gets the number of methods.
+   *
+   * @return The number of methods
+   */
+  std::size_t size() const
+  {
+    return m_count;
+  }
+
+private:
+
+  /**
+   * Maps the given method name hash to a hash table slot, according to the
+   * displacement of its bucket.
+   */
+  std::size_t slotOf(uint32_t hash, uint32_t displacement) const
+  {
+    uint32_t mixed = hash + displacement * 0x9e3779b9u;
+    mixed = (mixed ^ (mixed >> 16)) * 0x85ebca6bu;
+    mixed = (mixed ^ (mixed >> 13)) * 0xc2b2ae35u;
+    return (mixed ^ (mixed >> 16)) & m_slotMask;
+  }
+
+  /**
+   * Checks whether the specified method has the name of the given symbol.
+   */
+  bool hasName(MethodId methodId, const MethodSymbol &symbol) const
+  {
+    // Lengths first, so that names with embedded NULs or that are prefixes
+    // of a method name never read past the end of either name
+    return m_nameLengths[methodId] == symbol.length
+        && 0 == std::memcmp(m_methods[methodId].name, symbol.name, symbol.length);
+  }
+
+  /**
+   * The method descriptors, indexed by method id.
+   */
+  const MethodDescriptor *m_methods;
+
+  /**
+   * The number of methods.
+   */
+  std::size_t m_count;
+
+  /**
+   * The length of each method name, indexed by method id.
+   */
+  std::vector<std::size_t> m_nameLengths;
+
+  /**
+   * The hash table masks (their sizes, powers of two, minus one).
+   */
+  uint32_t m_slotMask;
+  uint32_t m_bucketMask;
+
+  /**
+   * The displacement of each bucket.
+   */
+  std::vector<uint32_t> m_displacements;
+
+  /**
+   * The hash table, which maps each slot to a method id. Empty if no perfect
+   * hash could be found, in which case names are looked up linearly.
+   */
+  std::vector<MethodId> m_slots;
+};
+
+#endif // PLUGIN_METHOD_H
@@ -6,27 +6,132 @@
 #include <dlfcn.h>
 #include "nlohmann/json.hpp"
 
-using json = nlohmann::json;
+using json = nlohmann::flat_json;
 
 #define PLUGIN_OPERATION "operation"
 
 using namespace std;
 
+/**
+ * Calls Operation::execute through the virtual table. Used by the workers,
+ * and by operation handles whenever the implementation cannot be resolved
+ * upfront.
+ */
+static double dispatchExecute(Operation *operation, double operandA, double operandB)
+{
+  return operation->execute(operandA, operandB);
+}
+
+
+/**
+ * Calls Operation::executeBatch through the virtual table. Used by the
+ * workers, and by operation handles whenever the implementation cannot be
+ * resolved upfront.
+ */
+static void dispatchExecuteBatch(Operation *operation,
+                                 const double *operandsA,
+                                 const double *operandsB,
+                                 double *results,
+                                 std::size_t count)
+{
+  operation->executeBatch(operandsA, operandsB, results, count);
+}
+
+
+/**
+ * Checks whether the plugin declares that a single instance may be used by
+ * concurrent threads. Used by the workers.
+ */
+static bool isSharedPlugin(Operation *operation)
+{
+  return PluginThreadSafety::Shared == operation->getThreadSafety();
+}
+
+
 /**
  * Constructor.
  */
 CalculatorEngine::CalculatorEngine()
+  : m_workerCount(0)
+  , m_workerPool(nullptr)
+  , m_stopping(0)
 {
 }
 
 
+/**
+ * Constructor.
+ *
+ * @param poolConfig The retention settings of the plugin instance pool
+ */
+CalculatorEngine::CalculatorEngine(const PluginPoolConfig &poolConfig)
+  : m_pluginPool(poolConfig)
+  , m_workerCount(0)
+  , m_workerPool(nullptr)
+  , m_stopping(0)
+{
+}
+
+
+/**
+ * Destructor.
+ * Waits for all submitted operations to complete.
+ */
+CalculatorEngine::~CalculatorEngine()
+{
+  // Other threads may still start the workers again while they are being
+  // stopped, so stop them until none are left
+  while (!stopWorkers().empty()) {
+  }
+}
+
+
+/**
+ * Sets the number of workers that run submitted operations (see
+ * submitOperation). Takes effect the next time the workers are started.
+ *
+ * @param count The number of workers, or 0 to use one worker per
+ *              hardware thread (the default)
+ */
+void CalculatorEngine::setWorkerCount(unsigned count)
+{
+  std::lock_guard<std::mutex> lock(m_workerPoolMutex);
+  m_workerCount = count;
+}
+
+
+/**
+ * Sets the directories searched for plugins when the engine starts,
+ * replacing the default ones.
+ *
+ * @param paths The plugin search directories, in search order
+ */
+void CalculatorEngine::setPluginSearchPaths(const std::vector<std::string> &paths)
+{
+  PluginRegistry::getSharedInstance().setSearchPaths(paths);
+}
+
+
 /**
  * Starts the calculator engine.
  * Internally, this method will initialize the plugin registry.
  */
 void CalculatorEngine::start()
 {
-  PluginRegistry::getSharedInstance().initialize();
+  start(false);
+}
+
+
+/**
+ * Starts the calculator engine.
+ * Internally, this method will initialize the plugin registry.
+ *
+ * @param rescanPlugins true to probe all plugin libraries, ignoring the
+ *                      plugin manifest cached by previous runs
+ */
+void CalculatorEngine::start(bool rescanPlugins)
+{
+  PluginRegistry::getSharedInstance().initialize(rescanPlugins);
   cout << "Calculator engine started" << endl;
 
   // Print out all plugin entries
@@ -35,7 +140,10 @@ void CalculatorEngine::start()
     cout << "found plugin { " 
          << "type: " << entry->getType() 
          << ", name: " << entry->getName() 
+         << ", version: " << entry->getVersion()
          << ", libName: " << entry->getLibName() 
+         << ", libPath: " << entry->getLibPath()
+         << ", probeTime: " << entry->getProbeTime().count() << "us"
          << " }" << std::endl;
   }
 }
@@ -43,9 +151,33 @@ void CalculatorEngine::start()
 
 /**
  * Stops the calculator engine.
+ * Internally, this method will wait for all submitted operations to
+ * complete, stop the workers, and unload all resident plugins.
+ * Operations submitted while the workers are stopping, e.g. by the
+ * callbacks of previous operations, complete right away with -1 (false for
+ * batches); operations submitted afterwards start the workers again.
  */
 void CalculatorEngine::stop()
 {
+  std::vector<WorkerStats> workerStats = stopWorkers();
+  for (std::size_t i = 0; i < workerStats.size(); ++i) {
+    cout << "Worker " << i << " { "
+         << "operations: " << workerStats[i].operations
+         << ", chunks: " << workerStats[i].chunks
+         << ", stolenChunks: " << workerStats[i].stolenChunks
+         << ", elements: " << workerStats[i].elements
+         << ", utilization: " << 100 * workerStats[i].getUtilization() << "%"
+         << " }" << endl;
+  }
+
+  PluginPoolStats stats = m_pluginPool.getStats();
+  cout << "Plugin pool { "
+       << "hits: " << stats.hits
+       << ", misses: " << stats.misses
+       << ", evictions: " << stats.evictions
+       << " }" << endl;
+
+  m_pluginPool.clear();
   cout << "Calculator engine stopped" << endl;
 }
 
@@ -57,7 +189,7 @@ void CalculatorEngine::stop()
  *
  * @return true if the operation is supported, otherwise false
  */
-bool CalculatorEngine::isOperationSupported(std::string name)
+bool CalculatorEngine::isOperationSupported(const std::string &name)
 {
   PluginEntry *pluginEntry = PluginRegistry::getSharedInstance().get(PLUGIN_OPERATION, name);
   if (!pluginEntry) {
@@ -78,7 +210,7 @@ bool CalculatorEngine::isOperationSupported(std::string name)
  *
  * @return The operation result
  */
-double CalculatorEngine::runOperation(std::string name, double operandA, double operandB)
+double CalculatorEngine::runOperation(const std::string &name, double operandA, double operandB)
 {
   // Discover the requested operation plugin by name
   PluginEntry *pluginEntry = PluginRegistry::getSharedInstance().get(PLUGIN_OPERATION, name);
@@ -86,8 +218,11 @@ double CalculatorEngine::runOperation(std::string name, double operandA, double
     return -1;
   }
 
-  // Create plugin instance
-  Operation *plugin = reinterpret_cast<Operation*>(PluginRegistry::getSharedInstance().loadPlugin(pluginEntry));
+  // Borrow the plugin instance from the pool
+  Operation *plugin = reinterpret_cast<Operation*>(m_pluginPool.acquire(pluginEntry));
+  if (!plugin) {
+    return -1;
+  }
 
   // Execute the plugin
   double result = plugin->execute(operandA, operandB);
@@ -98,9 +233,321 @@ double CalculatorEngine::runOperation(std::string name, double operandA, double
   json output = plugin->invokeMethod("execute", input);
   double result = output["result"].get<double>();
 #endif
-  // Destroy plugin instance
-  PluginRegistry::getSharedInstance().unloadPlugin(pluginEntry);
+  // Return the plugin instance to the pool, which keeps it resident
+  // according to its retention settings
+  m_pluginPool.release(pluginEntry);
 
   // Finally, return the operation result
   return result;
 }
+
+
+/**
+ * Submits the operation identified by the given name, with the two
+ * specified operands, for asynchronous execution. The operation is run by
+ * the engine workers, which are started by the first submission; each
+ * worker executes operations on plugin instances of its own, unless the
+ * plugin declares PluginThreadSafety::Shared.
+ *
+ * @param name The operation name
+ * @param operandA The first operand
+ * @param operandB The second operand
+ *
+ * @return A future that receives the operation result, or -1 if the
+ *         operation is not supported
+ */
+std::future<double> CalculatorEngine::submitOperation(const std::string &name,
+                                                      double operandA,
+                                                      double operandB)
+{
+  OperationTask task;
+  task.operandA = operandA;
+  task.operandB = operandB;
+  std::future<double> result = task.promise.get_future();
+  submit(name, std::move(task));
+  return result;
+}
+
+
+/**
+ * Submits the operation identified by the given name, with the two
+ * specified operands, for asynchronous execution, like the method above.
+ *
+ * @param name The operation name
+ * @param operandA The first operand
+ * @param operandB The second operand
+ * @param callback The callback that receives the operation result, or -1
+ *                 if the operation is not supported. It is called on the
+ *                 worker thread that ran the operation, or right away on
+ *                 the calling thread if the operation is not supported.
+ */
+void CalculatorEngine::submitOperation(const std::string &name, double operandA, double operandB,
+                                       OperationCallback callback)
+{
+  OperationTask task;
+  task.operandA = operandA;
+  task.operandB = operandB;
+  task.callback = std::move(callback);
+  submit(name, std::move(task));
+}
+
+
+/**
+ * Runs the operation identified by the given name on a batch of operand
+ * pairs, i.e. computes results[i] = operandsA[i] <op> operandsB[i] for
+ * every i < count, with a single plugin call.
+ *
+ * @param name The operation name
+ * @param operandsA The first operands
+ * @param operandsB The second operands
+ * @param results The output buffer, which receives count results
+ * @param count The number of operand pairs
+ *
+ * @return true on success, or false if the operation is not supported
+ */
+bool CalculatorEngine::runOperationBatch(const std::string &name,
+                                         const double *operandsA,
+                                         const double *operandsB,
+                                         double *results,
+                                         std::size_t count)
+{
+  PluginEntry *pluginEntry = PluginRegistry::getSharedInstance().get(PLUGIN_OPERATION, name);
+  if (!pluginEntry) {
+    return false;
+  }
+
+  Operation *plugin = reinterpret_cast<Operation*>(m_pluginPool.acquire(pluginEntry));
+  if (!plugin) {
+    return false;
+  }
+
+  // A single virtual dispatch for the whole batch
+  plugin->executeBatch(operandsA, operandsB, results, count);
+
+  m_pluginPool.release(pluginEntry);
+  return true;
+}
+
+
+/**
+ * Submits the operation identified by the given name on a batch of operand
+ * pairs for asynchronous execution, i.e. computes
+ * results[i] = operandsA[i] <op> operandsB[i] for every i < count. The
+ * batch is split into chunks that are run by all engine workers, which
+ * steal chunks from each other as they run out of their own (see
+ * OperationWorkerPool); the plugin runs on a single instance shared by
+ * the workers if it declares PluginThreadSafety::Shared, and on an
+ * instance per worker otherwise.
+ *
+ * @param name The operation name
+ * @param operandsA The first operands
+ * @param operandsB The second operands
+ * @param results The output buffer, which receives count results
+ * @param count The number of operand pairs
+ *
+ * @return A future that receives true once all results are computed, or
+ *         false if the operation is not supported or the workers are
+ *         stopping. The buffers must stay valid until then.
+ */
+std::future<bool> CalculatorEngine::submitOperationBatch(const std::string &name,
+                                                         const double *operandsA,
+                                                         const double *operandsB,
+                                                         double *results,
+                                                         std::size_t count)
+{
+  PluginEntry *pluginEntry = PluginRegistry::getSharedInstance().get(PLUGIN_OPERATION, name);
+  if (!pluginEntry) {
+    std::promise<bool> unsupported;
+    unsupported.set_value(false);
+    return unsupported.get_future();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_workerPoolMutex);
+    if (0 == m_stopping) {
+      return getWorkerPool()->submitBatch(pluginEntry, operandsA, operandsB, results, count);
+    }
+  }
+
+  // The workers are stopping
+  std::promise<bool> refused;
+  refused.set_value(false);
+  return refused.get_future();
+}
+
+
+/**
+ * Gets the name of the instruction set the batch implementation of the
+ * operation identified by the given name was specialized for on this host.
+ *
+ * @param name The operation name
+ *
+ * @return The instruction set name, or an empty string if the operation
+ *         is not supported
+ */
+std::string CalculatorEngine::getOperationInstructionSet(const std::string &name)
+{
+  PluginEntry *pluginEntry = PluginRegistry::getSharedInstance().get(PLUGIN_OPERATION, name);
+  if (!pluginEntry) {
+    return std::string();
+  }
+
+  Operation *plugin = reinterpret_cast<Operation*>(m_pluginPool.acquire(pluginEntry));
+  if (!plugin) {
+    return std::string();
+  }
+
+  std::string instructionSet = plugin->getInstructionSet();
+  m_pluginPool.release(pluginEntry);
+  return instructionSet;
+}
+
+
+/**
+ * Resolves the operation identified by the given name into a handle that
+ * can be cached and invoked repeatedly without any further lookup.
+ * The corresponding plugin instance is pinned in the plugin pool until the
+ * plugin registry is reinitialized, which also invalidates the handle.
+ *
+ * @param name The operation name
+ *
+ * @return The operation handle, which is invalid if the operation is not
+ *         supported
+ */
+OperationHandle CalculatorEngine::resolveOperation(const std::string &name)
+{
+  PluginRegistry &registry = PluginRegistry::getSharedInstance();
+
+  PluginEntry *pluginEntry = registry.get(PLUGIN_OPERATION, name);
+  if (!pluginEntry) {
+    return OperationHandle();
+  }
+
+  Operation *plugin = reinterpret_cast<Operation*>(m_pluginPool.pin(pluginEntry));
+  if (!plugin) {
+    return OperationHandle();
+  }
+
+  OperationHandle::ExecuteFunction execute = &dispatchExecute;
+  OperationHandle::ExecuteBatchFunction executeBatch = &dispatchExecuteBatch;
+#if defined(__GNUC__) && !defined(__clang__)
+  // GCC can extract the final overriders from the virtual table once
+  // (bound member function extension), so invocations skip the vtable load
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpmf-conversions"
+  execute = (OperationHandle::ExecuteFunction)(plugin->*(&Operation::execute));
+  executeBatch = (OperationHandle::ExecuteBatchFunction)(plugin->*(&Operation::executeBatch));
+#pragma GCC diagnostic pop
+#endif
+
+  return OperationHandle(plugin, execute, executeBatch, registry.getGenerationCounter());
+}
+
+
+/**
+ * Gets the counters of the plugin instance pool.
+ *
+ * @return A snapshot of the plugin pool counters
+ */
+PluginPoolStats CalculatorEngine::getPluginPoolStats() const
+{
+  return m_pluginPool.getStats();
+}
+
+
+/**
+ * Queues the given operation, starting the workers if needed.
+ *
+ * @param name The operation name
+ * @param task The operation, whose plugin entry is set by this method
+ */
+void CalculatorEngine::submit(const std::string &name, OperationTask &&task)
+{
+  // Unsupported operations complete right away, without a round trip
+  // through the workers
+  task.pluginEntry = PluginRegistry::getSharedInstance().get(PLUGIN_OPERATION, name);
+  if (!task.pluginEntry) {
+    task.complete(-1);
+    return;
+  }
+
+  // Submitting with the lock held keeps stopWorkers from deleting the pool
+  // in the meantime
+  {
+    std::lock_guard<std::mutex> lock(m_workerPoolMutex);
+    if (0 == m_stopping) {
+      getWorkerPool()->submit(std::move(task));
+      return;
+    }
+  }
+
+  // The workers are stopping, and would otherwise be started again by e.g.
+  // the callbacks stopWorkers waits for. The task completes without the
+  // lock, as its callback may submit operations in turn
+  task.complete(-1);
+}
+
+
+/**
+ * Gets the engine workers, starting them if needed. The caller must hold
+ * m_workerPoolMutex for as long as it uses the returned pool.
+ *
+ * @return The worker pool
+ */
+OperationWorkerPool *CalculatorEngine::getWorkerPool()
+{
+  if (nullptr == m_workerPool) {
+    OperationFunctions functions;
+    functions.execute = &dispatchExecute;
+    functions.executeBatch = &dispatchExecuteBatch;
+    functions.isShared = &isSharedPlugin;
+    m_workerPool = new OperationWorkerPool(m_pluginPool, functions, m_workerCount);
+  }
+  return m_workerPool;
+}
+
+
+/**
+ * Stops the workers, once all submitted operations are complete.
+ *
+ * @return The final counters of each worker, or an empty vector if the
+ *         workers were not started
+ */
+std::vector<WorkerStats> CalculatorEngine::stopWorkers()
+{
+  std::unique_ptr<OperationWorkerPool> workerPool;
+  {
+    std::lock_guard<std::mutex> lock(m_workerPoolMutex);
+    workerPool.reset(m_workerPool);
+    m_workerPool = nullptr;
+    if (!workerPool) {
+      return std::vector<WorkerStats>();
+    }
+    ++m_stopping;
+  }
+
+  // No submitter can reach the pool any more. It is stopped without the
+  // lock, as the callbacks it waits for may submit operations, which are
+  // refused until it is stopped
+  workerPool->stop();
+
+  std::lock_guard<std::mutex> lock(m_workerPoolMutex);
+  --m_stopping;
+  return workerPool->getStats();
+}
+
+
+/**
+ * Gets the counters of the engine workers, e.g. their utilization.
+ *
+ * @return A snapshot of the counters of each worker, or an empty vector
+ *         if the workers are not started
+ */
+std::vector<WorkerStats> CalculatorEngine::getWorkerStats() const
+{
+  std::lock_guard<std::mutex> lock(m_workerPoolMutex);
+  if (nullptr == m_workerPool) {
+    return std::vector<WorkerStats>();
+  }
+  return m_workerPool->getStats();
+}
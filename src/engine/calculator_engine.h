@@ -1,7 +1,14 @@
 #ifndef CALCULATOR_ENGINE_H
 #define CALCULATOR_ENGINE_H
 
+#include <cstddef>
+#include <future>
+#include <mutex>
 #include <string>
+#include <vector>
+#include "operation_handle.h"
+#include "operation_worker_pool.h"
+#include "plugin_pool.h"
 
 /**
  * Implements a generic and extensible calculator engine.
@@ -18,14 +25,58 @@ public:
    */
   CalculatorEngine();
 
+  /**
+   * Constructor.
+   *
+   * @param poolConfig The retention settings of the plugin instance pool
+   */
+  explicit CalculatorEngine(const PluginPoolConfig &poolConfig);
+
+  /**
+   * Destructor.
+   * Waits for all submitted operations to complete.
+   */
+  ~CalculatorEngine();
+
+  /**
+   * Sets the directories searched for plugins when the engine starts,
+   * replacing the default ones.
+   *
+   * @param paths The plugin search directories, in search order
+   */
+  void setPluginSearchPaths(const std::vector<std::string> &paths);
+
+  /**
+   * Sets the number of workers that run submitted operations (see
+   * submitOperation). Takes effect the next time the workers are started.
+   *
+   * @param count The number of workers, or 0 to use one worker per
+   *              hardware thread (the default)
+   */
+  void setWorkerCount(unsigned count);
+
   /**
    * Starts the calculator engine.
    * Internally, this method will initialize the plugin registry.
    */
   void start();
 
+  /**
+   * Starts the calculator engine.
+   * Internally, this method will initialize the plugin registry.
+   *
+   * @param rescanPlugins true to probe all plugin libraries, ignoring the
+   *                      plugin manifest cached by previous runs
+   */
+  void start(bool rescanPlugins);
+
   /**
    * Stops the calculator engine.
+   * Internally, this method will wait for all submitted operations to
+   * complete, stop the workers, and unload all resident plugins.
+   * Operations submitted while the workers are stopping, e.g. by the
+   * callbacks of previous operations, complete right away with -1 (false for
+   * batches); operations submitted afterwards start the workers again.
    */
   void stop();
 
@@ -36,12 +87,14 @@ public:
    *
    * @return true if the operation is supported, otherwise false
    */
-  bool isOperationSupported(std::string name);
+  bool isOperationSupported(const std::string &name);
 
   /**
    * Runs the operation identified by the given name, with the two specified
    * operands. This method will call the plugin that corresponds to the given 
-   * operation name to actually carry out the task.
+   * operation name to actually carry out the task, on the single pooled
+   * instance of the plugin: concurrent calls are only safe for plugins that
+   * declare PluginThreadSafety::Shared (see submitOperation otherwise).
    *
    * @param name The operation name
    * @param operandA The first operand
@@ -49,7 +102,185 @@ public:
    *
    * @return The operation result
    */
-  double runOperation(std::string name, double operandA, double operandB);
+  double runOperation(const std::string &name, double operandA, double operandB);
+
+  /**
+   * Submits the operation identified by the given name, with the two
+   * specified operands, for asynchronous execution. The operation is run by
+   * the engine workers, which are started by the first submission; each
+   * worker executes operations on plugin instances of its own, unless the
+   * plugin declares PluginThreadSafety::Shared.
+   *
+   * @param name The operation name
+   * @param operandA The first operand
+   * @param operandB The second operand
+   *
+   * @return A future that receives the operation result, -1 if the
+   *         operation is not supported or the workers are stopping (see
+   *         stop), or the exception thrown by the plugin
+   */
+  std::future<double> submitOperation(const std::string &name, double operandA, double operandB);
+
+  /**
+   * Submits the operation identified by the given name, with the two
+   * specified operands, for asynchronous execution, like the method above.
+   *
+   * @param name The operation name
+   * @param operandA The first operand
+   * @param operandB The second operand
+   * @param callback The callback that receives the operation result, or -1
+   *                 if the operation is not supported, the plugin threw
+   *                 an exception or the workers are stopping. It is called
+   *                 on the worker thread that ran the operation, or right
+   *                 away on the calling thread if the operation is not run.
+   */
+  void submitOperation(const std::string &name, double operandA, double operandB,
+                       OperationCallback callback);
+
+  /**
+   * Runs the operation identified by the given name on a batch of operand
+   * pairs, i.e. computes results[i] = operandsA[i] <op> operandsB[i] for
+   * every i < count, with a single plugin call. Like runOperation, it runs on
+   * the single pooled instance of the plugin.
+   *
+   * @param name The operation name
+   * @param operandsA The first operands
+   * @param operandsB The second operands
+   * @param results The output buffer, which receives count results
+   * @param count The number of operand pairs
+   *
+   * @return true on success, or false if the operation is not supported
+   */
+  bool runOperationBatch(const std::string &name,
+                         const double *operandsA,
+                         const double *operandsB,
+                         double *results,
+                         std::size_t count);
+
+  /**
+   * Submits the operation identified by the given name on a batch of operand
+   * pairs for asynchronous execution, i.e. computes
+   * results[i] = operandsA[i] <op> operandsB[i] for every i < count. The
+   * batch is split into chunks that are run by all engine workers, which
+   * steal chunks from each other as they run out of their own (see
+   * OperationWorkerPool); the plugin runs on a single instance shared by
+   * the workers if it declares PluginThreadSafety::Shared, and on an
+   * instance per worker otherwise.
+   *
+   * @param name The operation name
+   * @param operandsA The first operands
+   * @param operandsB The second operands
+   * @param results The output buffer, which receives count results
+   * @param count The number of operand pairs
+   *
+   * @return A future that receives true once all results are computed, or
+   *         false if the operation is not supported, the plugin threw an
+   *         exception or the workers are stopping. The buffers must stay
+   *         valid until then.
+   */
+  std::future<bool> submitOperationBatch(const std::string &name,
+                                         const double *operandsA,
+                                         const double *operandsB,
+                                         double *results,
+                                         std::size_t count);
+
+  /**
+   * Gets the name of the instruction set the batch implementation of the
+   * operation identified by the given name was specialized for on this host.
+   *
+   * @param name The operation name
+   *
+   * @return The instruction set name, or an empty string if the operation
+   *         is not supported
+   */
+  std::string getOperationInstructionSet(const std::string &name);
+
+  /**
+   * Resolves the operation identified by the given name into a handle that
+   * can be cached and invoked repeatedly without any further lookup.
+   * The corresponding plugin instance is pinned in the plugin pool until the
+   * plugin registry is reinitialized, which also invalidates the handle.
+   * Every handle to the operation invokes that same instance, so handles may
+   * only be invoked concurrently for plugins that declare
+   * PluginThreadSafety::Shared.
+   *
+   * @param name The operation name
+   *
+   * @return The operation handle, which is invalid if the operation is not
+   *         supported
+   */
+  OperationHandle resolveOperation(const std::string &name);
+
+  /**
+   * Gets the counters of the plugin instance pool.
+   *
+   * @return A snapshot of the plugin pool counters
+   */
+  PluginPoolStats getPluginPoolStats() const;
+
+  /**
+   * Gets the counters of the engine workers, e.g. their utilization.
+   *
+   * @return A snapshot of the counters of each worker, or an empty vector
+   *         if the workers are not started
+   */
+  std::vector<WorkerStats> getWorkerStats() const;
+
+private:
+
+  /**
+   * Queues the given operation, starting the workers if needed.
+   *
+   * @param name The operation name
+   * @param task The operation, whose plugin entry is set by this method
+   */
+  void submit(const std::string &name, OperationTask &&task);
+
+  /**
+   * Gets the engine workers, starting them if needed. The caller must hold
+   * m_workerPoolMutex for as long as it uses the returned pool.
+   *
+   * @return The worker pool
+   */
+  OperationWorkerPool *getWorkerPool();
+
+  /**
+   * Stops the workers, once all submitted operations are complete.
+   * Operations submitted in the meantime are refused (see m_stopping).
+   *
+   * @return The final counters of each worker, or an empty vector if the
+   *         workers were not started
+   */
+  std::vector<WorkerStats> stopWorkers();
+
+  /**
+   * The pool of resident plugin instances used by the operations.
+   */
+  PluginPool m_pluginPool;
+
+  /**
+   * The number of workers (0 = one per hardware thread).
+   */
+  unsigned m_workerCount;
+
+  /**
+   * The workers that run submitted operations, or nullptr until the first
+   * submission.
+   */
+  OperationWorkerPool *m_workerPool;
+
+  /**
+   * Guards m_workerPool, which submitters hold on to for the duration of a
+   * submission, so that the workers are not stopped and deleted under them.
+   */
+  mutable std::mutex m_workerPoolMutex;
+
+  /**
+   * The number of stopWorkers calls that are stopping a detached worker
+   * pool, guarded by m_workerPoolMutex. Submissions are refused while it is
+   * not 0, so that they do not start new workers behind the stopping ones.
+   */
+  unsigned m_stopping;
 };
 
 #endif // CALCULATOR_ENGINE_H
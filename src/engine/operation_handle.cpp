@@ -0,0 +1,35 @@
+#include "operation_handle.h"
+
+/**
+ * Constructor.
+ * Creates an invalid handle.
+ */
+OperationHandle::OperationHandle()
+  : m_operation(nullptr)
+  , m_execute(nullptr)
+  , m_executeBatch(nullptr)
+  , m_generationCounter(nullptr)
+  , m_generation(0)
+{
+}
+
+
+/**
+ * Constructor.
+ *
+ * @param operation The plugin instance
+ * @param execute The execute implementation of the plugin instance
+ * @param executeBatch The executeBatch implementation of the plugin instance
+ * @param generationCounter The registry generation counter
+ */
+OperationHandle::OperationHandle(Operation *operation,
+                                 ExecuteFunction execute,
+                                 ExecuteBatchFunction executeBatch,
+                                 const std::atomic<unsigned long> *generationCounter)
+  : m_operation(operation)
+  , m_execute(execute)
+  , m_executeBatch(executeBatch)
+  , m_generationCounter(generationCounter)
+  , m_generation(generationCounter->load(std::memory_order_acquire))
+{
+}
@@ -0,0 +1,127 @@
+#ifndef OPERATION_HANDLE_H
+#define OPERATION_HANDLE_H
+
+#include <atomic>
+#include <cstddef>
+
+class Operation;
+
+/**
+ * A lightweight, pre-resolved reference to an Operation plugin instance.
+ * Handles are obtained from CalculatorEngine::resolveOperation() and are meant
+ * to be cached by callers: invoking a handle skips the registry lookup and
+ * costs a single indirect call. A handle becomes invalid as soon as the
+ * plugin registry is reinitialized; invoking an invalid handle is safe and
+ * yields the same result as an unsupported operation.
+ */
+class OperationHandle
+{
+public:
+
+  /**
+   * The signature of a resolved Operation::execute implementation.
+   */
+  typedef double (*ExecuteFunction)(Operation*, double, double);
+
+  /**
+   * The signature of a resolved Operation::executeBatch implementation.
+   */
+  typedef void (*ExecuteBatchFunction)(Operation*, const double*, const double*, double*, std::size_t);
+
+  /**
+   * Constructor.
+   * Creates an invalid handle.
+   */
+  OperationHandle();
+
+  /**
+   * Constructor.
+   *
+   * @param operation The plugin instance
+   * @param execute The execute implementation of the plugin instance
+   * @param executeBatch The executeBatch implementation of the plugin instance
+   * @param generationCounter The registry generation counter
+   */
+  OperationHandle(Operation *operation,
+                  ExecuteFunction execute,
+                  ExecuteBatchFunction executeBatch,
+                  const std::atomic<unsigned long> *generationCounter);
+
+  /**
+   * Checks whether this handle may still be invoked.
+   *
+   * @return true if the handle is valid, otherwise false
+   */
+  bool isValid() const
+  {
+    return nullptr != m_generationCounter
+        && m_generation == m_generationCounter->load(std::memory_order_acquire);
+  }
+
+  /**
+   * Executes the referenced operation using the two given operands.
+   *
+   * @param operandA The first operand
+   * @param operandB The second operand
+   *
+   * @return The operation result, or -1 if the handle is invalid
+   */
+  double execute(double operandA, double operandB) const
+  {
+    if (!isValid()) {
+      return -1;
+    }
+    return m_execute(m_operation, operandA, operandB);
+  }
+
+  /**
+   * Executes the referenced operation on a batch of operand pairs.
+   *
+   * @param operandsA The first operands
+   * @param operandsB The second operands
+   * @param results The output buffer, which receives count results
+   * @param count The number of operand pairs
+   *
+   * @return true on success, or false if the handle is invalid
+   */
+  bool executeBatch(const double *operandsA,
+                    const double *operandsB,
+                    double *results,
+                    std::size_t count) const
+  {
+    if (!isValid()) {
+      return false;
+    }
+    m_executeBatch(m_operation, operandsA, operandsB, results, count);
+    return true;
+  }
+
+private:
+
+  /**
+   * The plugin instance.
+   */
+  Operation *m_operation;
+
+  /**
+   * The resolved execute implementation of the plugin instance.
+   */
+  ExecuteFunction m_execute;
+
+  /**
+   * The resolved executeBatch implementation of the plugin instance.
+   */
+  ExecuteBatchFunction m_executeBatch;
+
+  /**
+   * The registry generation counter.
+   */
+  const std::atomic<unsigned long> *m_generationCounter;
+
+  /**
+   * The registry generation this handle was resolved under.
+   */
+  unsigned long m_generation;
+};
+
+#endif // OPERATION_HANDLE_H
@@ -0,0 +1,480 @@
+#include "operation_worker_pool.h"
+#include "plugin_registry.h"
+#include <unistd.h>
+#include <algorithm>
+#include <iostream>
+
+/**
+ * The maximum number of elements of a batch chunk: 256 KiB of each of the
+ * operands and of the results, which stay in the cache of the worker.
+ */
+#define WORKER_POOL_MAX_CHUNK_SIZE 32768
+
+/**
+ * The number of chunks each worker is handed at least, when the batch is
+ * large enough, so that workers that finish early have chunks to steal.
+ */
+#define WORKER_POOL_CHUNKS_PER_WORKER 4
+
+/**
+ * Gets the time elapsed since the given time point, in nanoseconds.
+ */
+template<typename TimePoint>
+static std::int64_t NanosecondsSince(TimePoint start)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+/**
+ * Constructor.
+ * Starts the worker threads.
+ *
+ * @param pluginPool The plugin pool that keeps the plugin libraries loaded
+ * @param functions The Operation methods called by the workers
+ * @param workerCount The number of workers, or 0 to use one worker per
+ *                    hardware thread
+ */
+OperationWorkerPool::OperationWorkerPool(PluginPool &pluginPool,
+                                         const OperationFunctions &functions,
+                                         unsigned workerCount)
+  : m_pluginPool(pluginPool)
+  , m_functions(functions)
+  , m_pendingChunks(0)
+  , m_nextWorker(0)
+  , m_stopping(false)
+{
+  if (0 == workerCount) {
+    workerCount = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  m_workers.reserve(workerCount);
+  for (unsigned i = 0; i < workerCount; ++i) {
+    std::unique_ptr<Worker> worker(new Worker());
+    worker->index = i;
+    worker->registryGeneration = PluginRegistry::getSharedInstance().getGeneration();
+    worker->idleSince = -1;
+    worker->stoppedAt = -1;
+    worker->idleNanoseconds = 0;
+    worker->operations = 0;
+    worker->chunkCount = 0;
+    worker->stolenChunks = 0;
+    worker->elements = 0;
+    m_workers.push_back(std::move(worker));
+  }
+  for (auto &worker : m_workers) {
+    worker->startTime = Clock::now();
+    worker->thread = std::thread(&OperationWorkerPool::run, this, worker.get());
+  }
+}
+
+
+/**
+ * Destructor.
+ * Runs all submitted operations, then stops the worker threads.
+ */
+OperationWorkerPool::~OperationWorkerPool()
+{
+  stop();
+}
+
+
+/**
+ * Runs all submitted operations, then stops the worker threads. The
+ * counters of the workers remain available.
+ */
+void OperationWorkerPool::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_workAvailable.notify_all();
+
+  for (auto &worker : m_workers) {
+    if (worker->thread.joinable()) {
+      worker->thread.join();
+    }
+  }
+}
+
+
+/**
+ * Queues the specified operation for execution by the next idle worker.
+ *
+ * @param task The operation
+ */
+void OperationWorkerPool::submit(OperationTask &&task)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_tasks.push_back(std::move(task));
+  }
+  m_workAvailable.notify_one();
+}
+
+
+/**
+ * Queues the specified batch operation, split into chunks that are run by
+ * all workers, i.e. computes results[i] = operandsA[i] <op> operandsB[i]
+ * for every i < count. The buffers must stay valid until the returned
+ * future is ready.
+ *
+ * @param pluginEntry The plugin that implements the operation
+ * @param operandsA The first operands
+ * @param operandsB The second operands
+ * @param results The output buffer, which receives count results
+ * @param count The number of operand pairs
+ *
+ * @return A future that receives true once all results are computed, or
+ *         false if the plugin could not be run
+ */
+std::future<bool> OperationWorkerPool::submitBatch(PluginEntry *pluginEntry,
+                                                   const double *operandsA,
+                                                   const double *operandsB,
+                                                   double *results,
+                                                   std::size_t count)
+{
+  Batch *batch = new Batch();
+  batch->pluginEntry = pluginEntry;
+  batch->operandsA = operandsA;
+  batch->operandsB = operandsB;
+  batch->results = results;
+  batch->failed = false;
+  std::future<bool> future = batch->promise.get_future();
+
+  if (0 == count) {
+    batch->promise.set_value(true);
+    delete batch;
+    return future;
+  }
+
+  // Chunks are made of whole pages of results, so that no two workers write
+  // to the same page, and are small enough to balance the workers
+  const std::size_t workerCount = m_workers.size();
+  const std::size_t pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  const std::size_t pageElements = std::max<std::size_t>(1, pageSize / sizeof(double));
+  std::size_t chunkSize = count / (workerCount * WORKER_POOL_CHUNKS_PER_WORKER);
+  chunkSize = (chunkSize + pageElements - 1) / pageElements * pageElements;
+  chunkSize = std::min<std::size_t>(std::max(chunkSize, pageElements), WORKER_POOL_MAX_CHUNK_SIZE);
+
+  // The first chunk ends at a page boundary of the results
+  const std::size_t misalignment = reinterpret_cast<std::uintptr_t>(results) % pageSize;
+  const std::size_t head = misalignment > 0 ? (pageSize - misalignment) / sizeof(double) : 0;
+
+  std::vector<Chunk> chunks;
+  chunks.reserve((count + chunkSize - 1) / chunkSize + 1);
+  for (std::size_t begin = 0; begin < count;) {
+    const std::size_t end = std::min(count, begin == 0 ? head + chunkSize : begin + chunkSize);
+    Chunk chunk = { batch, begin, end };
+    chunks.push_back(chunk);
+    begin = end;
+  }
+  batch->remainingChunks = chunks.size();
+
+  // Announced before they are queued, so that no worker sees a count that
+  // has not been increased yet
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pendingChunks += chunks.size();
+  }
+
+  // Each worker is handed a contiguous range of chunks, starting with a
+  // different worker for every batch
+  const std::size_t firstWorker = m_nextWorker++ % workerCount;
+  for (std::size_t i = 0; i < workerCount; ++i) {
+    const std::size_t begin = chunks.size() * i / workerCount;
+    const std::size_t end = chunks.size() * (i + 1) / workerCount;
+    if (begin == end) {
+      continue;
+    }
+    Worker *worker = m_workers[(firstWorker + i) % workerCount].get();
+    std::lock_guard<std::mutex> lock(worker->chunksMutex);
+    worker->chunks.insert(worker->chunks.end(), chunks.begin() + begin, chunks.begin() + end);
+  }
+  m_workAvailable.notify_all();
+
+  return future;
+}
+
+
+/**
+ * Gets the counters of the workers.
+ *
+ * @return A snapshot of the counters of each worker, in worker order
+ */
+std::vector<WorkerStats> OperationWorkerPool::getStats() const
+{
+  std::vector<WorkerStats> stats;
+  stats.reserve(m_workers.size());
+  for (auto &worker : m_workers) {
+    std::int64_t now = worker->stoppedAt.load();
+    if (now < 0) {
+      now = NanosecondsSince(worker->startTime);
+    }
+    std::int64_t idle = static_cast<std::int64_t>(worker->idleNanoseconds.load());
+    const std::int64_t idleSince = worker->idleSince.load();
+    if (idleSince >= 0 && now > idleSince) {
+      idle += now - idleSince;
+    }
+
+    WorkerStats workerStats;
+    workerStats.operations = worker->operations.load(std::memory_order_relaxed);
+    workerStats.chunks = worker->chunkCount.load(std::memory_order_relaxed);
+    workerStats.stolenChunks = worker->stolenChunks.load(std::memory_order_relaxed);
+    workerStats.elements = worker->elements.load(std::memory_order_relaxed);
+    workerStats.upTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds(now));
+    workerStats.busyTime = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::nanoseconds(std::max<std::int64_t>(0, now - idle)));
+    stats.push_back(workerStats);
+  }
+  return stats;
+}
+
+
+/**
+ * Marks the given worker idle from now on, unless it already is.
+ *
+ * @param worker The calling worker
+ */
+void OperationWorkerPool::BeginIdle(Worker *worker)
+{
+  if (worker->idleSince.load() < 0) {
+    worker->idleSince = NanosecondsSince(worker->startTime);
+  }
+}
+
+
+/**
+ * Marks the given worker busy, adding the time it was idle, if any, to its
+ * idle time.
+ *
+ * @param worker The calling worker
+ */
+void OperationWorkerPool::EndIdle(Worker *worker)
+{
+  const std::int64_t idleSince = worker->idleSince.load();
+  if (idleSince >= 0) {
+    worker->idleNanoseconds += static_cast<std::uint64_t>(NanosecondsSince(worker->startTime) - idleSince);
+    worker->idleSince = -1;
+  }
+}
+
+
+/**
+ * Runs chunks and operations until the pool is stopped and there is
+ * nothing left to run.
+ *
+ * @param worker The calling worker
+ */
+void OperationWorkerPool::run(Worker *worker)
+{
+  while (true) {
+    // Batch chunks first, as the caller waits for the last one
+    Chunk chunk;
+    if (takeChunk(worker, &chunk)) {
+      EndIdle(worker);
+      runChunk(worker, chunk);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_tasks.empty()) {
+      OperationTask task(std::move(m_tasks.front()));
+      m_tasks.pop_front();
+      lock.unlock();
+      EndIdle(worker);
+
+      // Neither the plugin nor the callback may take the worker down
+      double result = -1;
+      std::exception_ptr error;
+      try {
+        Operation *plugin = getInstance(worker, task.pluginEntry);
+        if (nullptr != plugin) {
+          result = m_functions.execute(plugin, task.operandA, task.operandB);
+        }
+      }
+      catch (...) {
+        error = std::current_exception();
+      }
+      try {
+        if (error) {
+          task.fail(error);
+        } else {
+          task.complete(result);
+        }
+      }
+      catch (...) {
+        std::cerr << "Ignoring exception thrown by operation callback" << std::endl;
+      }
+      worker->operations.fetch_add(1, std::memory_order_relaxed);
+      continue;
+    }
+
+    // Chunks are announced before they are queued. Waiting for them counts
+    // as idle time, until the worker takes a chunk or an operation
+    if (m_pendingChunks.load() > 0) {
+      lock.unlock();
+      BeginIdle(worker);
+      std::this_thread::yield();
+      continue;
+    }
+
+    if (m_stopping) {
+      break;
+    }
+
+    BeginIdle(worker);
+    m_workAvailable.wait(lock, [this] {
+      return m_stopping || !m_tasks.empty() || m_pendingChunks.load() > 0;
+    });
+  }
+  EndIdle(worker);
+
+  destroyInstances(worker);
+  worker->stoppedAt = NanosecondsSince(worker->startTime);
+}
+
+
+/**
+ * Takes the next chunk of the given worker, or else steals the last chunk
+ * of another worker.
+ *
+ * @param worker The calling worker
+ * @param chunk Receives the chunk
+ *
+ * @return true if a chunk was taken, otherwise false
+ */
+bool OperationWorkerPool::takeChunk(Worker *worker, Chunk *chunk)
+{
+  if (0 == m_pendingChunks.load()) {
+    return false;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(worker->chunksMutex);
+    if (!worker->chunks.empty()) {
+      *chunk = worker->chunks.front();
+      worker->chunks.pop_front();
+      --m_pendingChunks;
+      return true;
+    }
+  }
+
+  // Steal from the far end of the range of another worker, which its owner
+  // would run last
+  for (std::size_t i = 1; i < m_workers.size(); ++i) {
+    Worker *victim = m_workers[(worker->index + i) % m_workers.size()].get();
+    std::lock_guard<std::mutex> lock(victim->chunksMutex);
+    if (!victim->chunks.empty()) {
+      *chunk = victim->chunks.back();
+      victim->chunks.pop_back();
+      --m_pendingChunks;
+      worker->stolenChunks.fetch_add(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+
+/**
+ * Runs the given chunk, and completes its batch if it is the last one.
+ *
+ * @param worker The calling worker
+ * @param chunk The chunk
+ */
+void OperationWorkerPool::runChunk(Worker *worker, const Chunk &chunk)
+{
+  Batch *batch = chunk.batch;
+  if (!batch->failed.load(std::memory_order_relaxed)) {
+    try {
+      Operation *plugin = getInstance(worker, batch->pluginEntry);
+      if (nullptr != plugin) {
+        m_functions.executeBatch(plugin,
+                                 batch->operandsA + chunk.begin,
+                                 batch->operandsB + chunk.begin,
+                                 batch->results + chunk.begin,
+                                 chunk.end - chunk.begin);
+        worker->elements.fetch_add(chunk.end - chunk.begin, std::memory_order_relaxed);
+      } else {
+        batch->failed = true;
+      }
+    }
+    catch (...) {
+      // The remaining chunks are skipped, and the batch completes as failed
+      batch->failed = true;
+    }
+  }
+  worker->chunkCount.fetch_add(1, std::memory_order_relaxed);
+
+  if (1 == batch->remainingChunks.fetch_sub(1, std::memory_order_acq_rel)) {
+    batch->promise.set_value(!batch->failed.load());
+    delete batch;
+  }
+}
+
+
+/**
+ * Gets the plugin instance the given worker runs the specified plugin on,
+ * creating it if needed.
+ *
+ * @param worker The calling worker
+ * @param pluginEntry Pointer to the corresponding plugin entry
+ *
+ * @return A pointer to the plugin instance, or nullptr
+ */
+Operation *OperationWorkerPool::getInstance(Worker *worker, PluginEntry *pluginEntry)
+{
+  PluginRegistry &registry = PluginRegistry::getSharedInstance();
+
+  // A reinitialized registry has already destroyed every instance we own,
+  // and the plugin pool has dropped our borrows
+  unsigned long generation = registry.getGeneration();
+  if (generation != worker->registryGeneration) {
+    worker->instances.clear();
+    worker->registryGeneration = generation;
+  }
+
+  std::map<PluginEntry*, Operation*>::const_iterator instance = worker->instances.find(pluginEntry);
+  if (instance != worker->instances.end()) {
+    return instance->second;
+  }
+
+  // Instances are destroyed along with their library, which the pool does
+  // not unload while the worker borrows it (until destroyInstances)
+  Operation *plugin = reinterpret_cast<Operation*>(m_pluginPool.acquire(pluginEntry));
+  if (nullptr == plugin) {
+    return nullptr;
+  }
+  if (!m_functions.isShared(plugin)) {
+    plugin = reinterpret_cast<Operation*>(registry.createPluginInstance(pluginEntry));
+    if (nullptr == plugin) {
+      m_pluginPool.release(pluginEntry);
+      return nullptr;
+    }
+  }
+  worker->instances[pluginEntry] = plugin;
+  return plugin;
+}
+
+
+/**
+ * Destroys the plugin instances owned by the given worker, and returns the
+ * plugins borrowed for them to the plugin pool.
+ *
+ * @param worker The calling worker
+ */
+void OperationWorkerPool::destroyInstances(Worker *worker)
+{
+  // Shared instances belong to the plugin pool, and are left alone by the
+  // registry
+  PluginRegistry &registry = PluginRegistry::getSharedInstance();
+  if (registry.getGeneration() == worker->registryGeneration) {
+    for (auto &instance : worker->instances) {
+      registry.destroyPluginInstance(instance.first, instance.second);
+      m_pluginPool.release(instance.first);
+    }
+  }
+  worker->instances.clear();
+}
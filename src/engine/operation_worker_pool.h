@@ -0,0 +1,436 @@
+#ifndef OPERATION_WORKER_POOL_H
+#define OPERATION_WORKER_POOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "operation_handle.h"
+#include "plugin_entry.h"
+#include "plugin_pool.h"
+
+/**
+ * The completion callback of an asynchronous operation. It is called with
+ * the operation result, or -1 if the operation could not be run.
+ */
+typedef std::function<void(double result)> OperationCallback;
+
+/**
+ * An operation submitted to the worker pool. Its result is delivered through
+ * the callback if one is set, and through the promise otherwise.
+ */
+struct OperationTask
+{
+  /**
+   * The plugin that implements the operation.
+   */
+  PluginEntry *pluginEntry;
+
+  /**
+   * The first operand.
+   */
+  double operandA;
+
+  /**
+   * The second operand.
+   */
+  double operandB;
+
+  /**
+   * Receives the result, unless a callback is set.
+   */
+  std::promise<double> promise;
+
+  /**
+   * Receives the result, if set.
+   */
+  OperationCallback callback;
+
+  /**
+   * Delivers the result of the operation.
+   *
+   * @param result The operation result
+   */
+  void complete(double result)
+  {
+    if (callback) {
+      callback(result);
+    } else {
+      promise.set_value(result);
+    }
+  }
+
+  /**
+   * Delivers the exception the operation failed with. A callback cannot
+   * receive it, and gets -1 instead, as for an operation that could not be
+   * run.
+   *
+   * @param error The exception
+   */
+  void fail(std::exception_ptr error)
+  {
+    if (callback) {
+      callback(-1);
+    } else {
+      promise.set_exception(error);
+    }
+  }
+};
+
+
+/**
+ * The Operation methods called by the worker pool, which the engine resolves
+ * so that the pool does not depend on the definition of the Operation
+ * interface.
+ */
+struct OperationFunctions
+{
+  /**
+   * Calls Operation::execute.
+   */
+  OperationHandle::ExecuteFunction execute;
+
+  /**
+   * Calls Operation::executeBatch.
+   */
+  OperationHandle::ExecuteBatchFunction executeBatch;
+
+  /**
+   * Checks whether the plugin declares PluginThreadSafety::Shared.
+   */
+  bool (*isShared)(Operation*);
+};
+
+
+/**
+ * The counters of a worker.
+ */
+struct WorkerStats
+{
+  /**
+   * Constructor.
+   */
+  WorkerStats()
+    : operations(0)
+    , chunks(0)
+    , stolenChunks(0)
+    , elements(0)
+    , busyTime(0)
+    , upTime(0)
+  {
+  }
+
+  /**
+   * Gets the share of its up time the worker spent running operations.
+   *
+   * @return The utilization, between 0 and 1
+   */
+  double getUtilization() const
+  {
+    return upTime.count() > 0 ? static_cast<double>(busyTime.count()) / upTime.count() : 0;
+  }
+
+  /**
+   * The number of single operations run.
+   */
+  std::size_t operations;
+
+  /**
+   * The number of batch chunks run, including the stolen ones.
+   */
+  std::size_t chunks;
+
+  /**
+   * The number of batch chunks taken from the queues of other workers.
+   */
+  std::size_t stolenChunks;
+
+  /**
+   * The number of batch elements computed.
+   */
+  std::size_t elements;
+
+  /**
+   * The time spent running (or looking for) operations.
+   */
+  std::chrono::microseconds busyTime;
+
+  /**
+   * The time since the worker was started.
+   */
+  std::chrono::microseconds upTime;
+};
+
+
+/**
+ * Runs operations asynchronously on a fixed set of worker threads.
+ *
+ * Single operations are started in submission order, from a queue shared by
+ * all workers; a slow operation occupies one worker only, while the others
+ * keep draining the queue.
+ *
+ * Batches are split into chunks, which are run ahead of single operations.
+ * Each worker is handed a contiguous range of chunks, which it runs in
+ * order; a worker that runs out of chunks steals them from the far end of
+ * the range of another worker. Chunk boundaries fall on page boundaries of
+ * the results, so that no two workers write to the same page or cache line
+ * (no false sharing). Chunking is page-granular only: workers are not
+ * pinned to cores, and the placement of the buffers on NUMA nodes is left
+ * to the caller.
+ *
+ * Plugins that declare PluginThreadSafety::Shared are run on the instance of
+ * the plugin pool by all workers at once. For any other plugin, every worker
+ * creates an instance of its own the first time it runs the plugin, so that
+ * workers never contend for an instance. A worker borrows each plugin it
+ * runs from the plugin pool until it stops, as its instances live as long
+ * as their library; the retention settings of the pool apply once the
+ * workers are stopped.
+ */
+class OperationWorkerPool
+{
+public:
+
+  /**
+   * Constructor.
+   * Starts the worker threads.
+   *
+   * @param pluginPool The plugin pool that keeps the plugin libraries loaded
+   * @param functions The Operation methods called by the workers
+   * @param workerCount The number of workers, or 0 to use one worker per
+   *                    hardware thread
+   */
+  OperationWorkerPool(PluginPool &pluginPool,
+                      const OperationFunctions &functions,
+                      unsigned workerCount);
+
+  /**
+   * Destructor.
+   * Runs all submitted operations, then stops the worker threads.
+   */
+  ~OperationWorkerPool();
+
+  /**
+   * Runs all submitted operations, then stops the worker threads. The
+   * counters of the workers remain available.
+   */
+  void stop();
+
+  /**
+   * Queues the specified operation for execution by the next idle worker.
+   * An exception thrown by the plugin is delivered through the promise of
+   * the operation; one thrown by its callback is reported and dropped.
+   *
+   * @param task The operation
+   */
+  void submit(OperationTask &&task);
+
+  /**
+   * Queues the specified batch operation, split into chunks that are run by
+   * all workers, i.e. computes results[i] = operandsA[i] <op> operandsB[i]
+   * for every i < count. The buffers must stay valid until the returned
+   * future is ready.
+   *
+   * @param pluginEntry The plugin that implements the operation
+   * @param operandsA The first operands
+   * @param operandsB The second operands
+   * @param results The output buffer, which receives count results
+   * @param count The number of operand pairs
+   *
+   * @return A future that receives true once all results are computed, or
+   *         false if the plugin could not be run or threw an exception
+   */
+  std::future<bool> submitBatch(PluginEntry *pluginEntry,
+                                const double *operandsA,
+                                const double *operandsB,
+                                double *results,
+                                std::size_t count);
+
+  /**
+   * Gets the number of workers.
+   *
+   * @return The number of workers
+   */
+  unsigned getWorkerCount() const
+  {
+    return static_cast<unsigned>(m_workers.size());
+  }
+
+  /**
+   * Gets the counters of the workers.
+   *
+   * @return A snapshot of the counters of each worker, in worker order
+   */
+  std::vector<WorkerStats> getStats() const;
+
+private:
+
+  typedef std::chrono::steady_clock Clock;
+
+  /**
+   * A batch operation, which completes when its last chunk does.
+   */
+  struct Batch
+  {
+    PluginEntry *pluginEntry;
+    const double *operandsA;
+    const double *operandsB;
+    double *results;
+    std::atomic<std::size_t> remainingChunks;
+    std::atomic<bool> failed;
+    std::promise<bool> promise;
+  };
+
+  /**
+   * A range of the elements of a batch.
+   */
+  struct Chunk
+  {
+    Batch *batch;
+    std::size_t begin;
+    std::size_t end;
+  };
+
+  /**
+   * A worker thread, its queue of chunks, the plugin instances it owns, and
+   * its counters. Times are in nanoseconds since the start of the worker;
+   * idleSince is -1 while the worker is busy, and stoppedAt while it runs.
+   */
+  struct Worker
+  {
+    unsigned index;
+    std::thread thread;
+    std::deque<Chunk> chunks;
+    std::mutex chunksMutex;
+    std::map<PluginEntry*, Operation*> instances;
+    unsigned long registryGeneration;
+    Clock::time_point startTime;
+    std::atomic<std::int64_t> idleSince;
+    std::atomic<std::int64_t> stoppedAt;
+    std::atomic<std::uint64_t> idleNanoseconds;
+    std::atomic<std::size_t> operations;
+    std::atomic<std::size_t> chunkCount;
+    std::atomic<std::size_t> stolenChunks;
+    std::atomic<std::size_t> elements;
+  };
+
+  /**
+   * Marks the given worker idle from now on, unless it already is.
+   *
+   * @param worker The calling worker
+   */
+  static void BeginIdle(Worker *worker);
+
+  /**
+   * Marks the given worker busy, adding the time it was idle, if any, to
+   * its idle time.
+   *
+   * @param worker The calling worker
+   */
+  static void EndIdle(Worker *worker);
+
+  /**
+   * Runs chunks and operations until the pool is stopped and there is
+   * nothing left to run.
+   *
+   * @param worker The calling worker
+   */
+  void run(Worker *worker);
+
+  /**
+   * Takes the next chunk of the given worker, or else steals the last chunk
+   * of another worker.
+   *
+   * @param worker The calling worker
+   * @param chunk Receives the chunk
+   *
+   * @return true if a chunk was taken, otherwise false
+   */
+  bool takeChunk(Worker *worker, Chunk *chunk);
+
+  /**
+   * Runs the given chunk, and completes its batch if it is the last one.
+   *
+   * @param worker The calling worker
+   * @param chunk The chunk
+   */
+  void runChunk(Worker *worker, const Chunk &chunk);
+
+  /**
+   * Gets the plugin instance the given worker runs the specified plugin on,
+   * creating it if needed.
+   *
+   * @param worker The calling worker
+   * @param pluginEntry Pointer to the corresponding plugin entry
+   *
+   * @return A pointer to the plugin instance, or nullptr
+   */
+  Operation *getInstance(Worker *worker, PluginEntry *pluginEntry);
+
+  /**
+   * Destroys the plugin instances owned by the given worker, and returns the
+   * plugins borrowed for them to the plugin pool.
+   *
+   * @param worker The calling worker
+   */
+  void destroyInstances(Worker *worker);
+
+  /**
+   * The plugin pool that keeps the plugin libraries loaded.
+   */
+  PluginPool &m_pluginPool;
+
+  /**
+   * The Operation methods called by the workers.
+   */
+  OperationFunctions m_functions;
+
+  /**
+   * The workers.
+   */
+  std::vector<std::unique_ptr<Worker> > m_workers;
+
+  /**
+   * The single operations waiting for a worker, in submission order.
+   */
+  std::deque<OperationTask> m_tasks;
+
+  /**
+   * The number of chunks queued and not yet taken by a worker. Only
+   * increased with the mutex held, so that waiting workers are woken up.
+   */
+  std::atomic<std::size_t> m_pendingChunks;
+
+  /**
+   * The worker the chunks of the next batch are handed to first, so that
+   * small batches are spread over the workers.
+   */
+  std::atomic<unsigned> m_nextWorker;
+
+  /**
+   * Set when the pool is being stopped.
+   */
+  bool m_stopping;
+
+  /**
+   * Guards the queue of single operations.
+   */
+  std::mutex m_mutex;
+
+  /**
+   * Signals workers that there is something to run, or that the pool is
+   * being stopped.
+   */
+  std::condition_variable m_workAvailable;
+};
+
+#endif // OPERATION_WORKER_POOL_H
@@ -6,11 +6,15 @@
  * @param type The plugin type
  * @param name The plugin name
  * @param libName The plugin library name
+ * @param libPath The plugin library path
  */
-PluginEntry::PluginEntry(std::string type, std::string name, std::string libName)
+PluginEntry::PluginEntry(std::string type, std::string name, std::string libName, std::string libPath)
   : m_type(type)
   , m_name(name)
   , m_libName(libName)
+  , m_libPath(libPath)
+  , m_id(type + "::" + name)
+  , m_probeTime(0)
 {
 }
 
@@ -28,9 +32,9 @@ PluginEntry::~PluginEntry()
  * 
  * @return The plugin id
  */
-std::string PluginEntry::getId() const
+const std::string &PluginEntry::getId() const
 {
-  return m_type + "::" + m_name;
+  return m_id;
 }
 
 
@@ -39,7 +43,7 @@ std::string PluginEntry::getId() const
  *
  * @return The plugin type
  */
-std::string PluginEntry::getType() const
+const std::string &PluginEntry::getType() const
 {
   return m_type;
 }
@@ -50,7 +54,7 @@ std::string PluginEntry::getType() const
  *
  * @return The plugin name
  */
-std::string PluginEntry::getName() const
+const std::string &PluginEntry::getName() const
 {
   return m_name;
 }
@@ -61,7 +65,63 @@ std::string PluginEntry::getName() const
  *
  * @return The plugin library name
  */
-std::string PluginEntry::getLibName() const
+const std::string &PluginEntry::getLibName() const
 {
   return m_libName;
 }
+
+
+/**
+ * Gets the plugin library path, which the library is loaded from.
+ *
+ * @return The plugin library path
+ */
+const std::string &PluginEntry::getLibPath() const
+{
+  return m_libPath;
+}
+
+
+/**
+ * Gets the plugin version.
+ *
+ * @return The plugin version, or an empty string for plugins that do not
+ *         declare their metadata
+ */
+const std::string &PluginEntry::getVersion() const
+{
+  return m_version;
+}
+
+
+/**
+ * Sets the plugin version.
+ *
+ * @param version The plugin version
+ */
+void PluginEntry::setVersion(const std::string &version)
+{
+  m_version = version;
+}
+
+
+/**
+ * Gets the time it took to probe the plugin library during discovery.
+ *
+ * @return The probe time
+ */
+std::chrono::microseconds PluginEntry::getProbeTime() const
+{
+  return m_probeTime;
+}
+
+
+/**
+ * Sets the time it took to probe the plugin library during discovery.
+ *
+ * @param probeTime The probe time
+ */
+void PluginEntry::setProbeTime(std::chrono::microseconds probeTime)
+{
+  m_probeTime = probeTime;
+}
@@ -1,6 +1,7 @@
 #ifndef PLUGIN_ENTRY_H
 #define PLUGIN_ENTRY_H
 
+#include <chrono>
 #include <string>
 
 /**
@@ -16,8 +17,9 @@ public:
    * @param type The plugin type
    * @param name The plugin name
    * @param libName The plugin library name
+   * @param libPath The plugin library path
    */
-  PluginEntry(std::string type, std::string name, std::string libName);
+  PluginEntry(std::string type, std::string name, std::string libName, std::string libPath);
 
   /**
    * Destructor.
@@ -29,28 +31,64 @@ public:
    * 
    * @return The plugin id
    */
-  std::string getId() const;
+  const std::string &getId() const;
 
   /**
    * Gets the plugin type.
    *
    * @return The plugin type
    */
-  std::string getType() const;
+  const std::string &getType() const;
   
   /**
    * Gets the plugin name.
    *
    * @return The plugin name
    */
-  std::string getName() const;
+  const std::string &getName() const;
   
   /**
    * Gets the plugin library name.
    *
    * @return The plugin library name
    */
-  std::string getLibName() const;
+  const std::string &getLibName() const;
+
+  /**
+   * Gets the plugin library path, which the library is loaded from.
+   *
+   * @return The plugin library path
+   */
+  const std::string &getLibPath() const;
+
+  /**
+   * Gets the plugin version.
+   *
+   * @return The plugin version, or an empty string for plugins that do not
+   *         declare their metadata
+   */
+  const std::string &getVersion() const;
+
+  /**
+   * Sets the plugin version.
+   *
+   * @param version The plugin version
+   */
+  void setVersion(const std::string &version);
+
+  /**
+   * Gets the time it took to probe the plugin library during discovery.
+   *
+   * @return The probe time
+   */
+  std::chrono::microseconds getProbeTime() const;
+
+  /**
+   * Sets the time it took to probe the plugin library during discovery.
+   *
+   * @param probeTime The probe time
+   */
+  void setProbeTime(std::chrono::microseconds probeTime);
 
 
 private:
@@ -69,6 +107,26 @@ private:
    * The plugin library name.
    */
   std::string m_libName;
+
+  /**
+   * The plugin library path.
+   */
+  std::string m_libPath;
+
+  /**
+   * The plugin id, computed once upon construction.
+   */
+  std::string m_id;
+
+  /**
+   * The plugin version.
+   */
+  std::string m_version;
+
+  /**
+   * The time it took to probe the plugin library.
+   */
+  std::chrono::microseconds m_probeTime;
 };
 
 #endif // PLUGIN_ENTRY_H
@@ -0,0 +1,188 @@
+#include "plugin_index.h"
+#include <algorithm>
+#include <cstring>
+
+/**
+ * The initial hash table capacity.
+ */
+#define PLUGIN_INDEX_INITIAL_CAPACITY 16
+
+/**
+ * Orders plugin entries by type and name.
+ */
+static bool EntryLess(const PluginEntry *a, const PluginEntry *b)
+{
+  if (a->getType() != b->getType()) {
+    return a->getType() < b->getType();
+  }
+  return a->getName() < b->getName();
+}
+
+
+/**
+ * Checks whether the given entry has the specified type and name.
+ */
+static bool EntryMatches(const PluginEntry *entry,
+                         const char *type, std::size_t typeLength,
+                         const char *name, std::size_t nameLength)
+{
+  const std::string &entryType = entry->getType();
+  const std::string &entryName = entry->getName();
+  return entryType.size() == typeLength
+      && entryName.size() == nameLength
+      && 0 == std::memcmp(entryType.data(), type, typeLength)
+      && 0 == std::memcmp(entryName.data(), name, nameLength);
+}
+
+
+/**
+ * Constructor.
+ */
+PluginIndex::PluginIndex()
+{
+  Slot empty = { 0, nullptr };
+  m_slots.assign(PLUGIN_INDEX_INITIAL_CAPACITY, empty);
+}
+
+
+/**
+ * Destructor.
+ * Deletes all indexed entries.
+ */
+PluginIndex::~PluginIndex()
+{
+  for (auto entry : m_entries) {
+    delete entry;
+  }
+}
+
+
+/**
+ * Adds the given entry to the index, which takes ownership of it.
+ *
+ * @param pluginEntry The plugin entry to add
+ *
+ * @return true if the entry was added, or false if an entry with the same
+ *         type and name already exists (ownership stays with the caller)
+ */
+bool PluginIndex::insert(PluginEntry *pluginEntry)
+{
+  const std::string &type = pluginEntry->getType();
+  const std::string &name = pluginEntry->getName();
+  if (nullptr != find(type.data(), type.size(), name.data(), name.size())) {
+    return false;
+  }
+
+  // Keep the load factor at or below one half
+  if (2 * (m_entries.size() + 1) > m_slots.size()) {
+    grow();
+  }
+  place(Hash(type.data(), type.size(), name.data(), name.size()), pluginEntry);
+
+  m_entries.insert(std::upper_bound(m_entries.begin(), m_entries.end(), pluginEntry, EntryLess),
+                   pluginEntry);
+  return true;
+}
+
+
+/**
+ * Finds the entry with the specified type and name.
+ *
+ * @param type The plugin type characters
+ * @param typeLength The plugin type length
+ * @param name The plugin name characters
+ * @param nameLength The plugin name length
+ *
+ * @return The plugin entry, or nullptr
+ */
+PluginEntry *PluginIndex::find(const char *type, std::size_t typeLength,
+                               const char *name, std::size_t nameLength) const
+{
+  std::uint64_t hash = Hash(type, typeLength, name, nameLength);
+  std::size_t mask = m_slots.size() - 1;
+
+  // Linear probing; the table always has free slots, so the loop ends
+  for (std::size_t i = static_cast<std::size_t>(hash) & mask; ; i = (i + 1) & mask) {
+    const Slot &slot = m_slots[i];
+    if (nullptr == slot.entry) {
+      return nullptr;
+    }
+    if (slot.hash == hash && EntryMatches(slot.entry, type, typeLength, name, nameLength)) {
+      return slot.entry;
+    }
+  }
+}
+
+
+/**
+ * Gets all indexed entries, ordered by type and name.
+ *
+ * @return The indexed entries
+ */
+const std::vector<PluginEntry*> &PluginIndex::getAll() const
+{
+  return m_entries;
+}
+
+
+/**
+ * Checks whether the index is empty.
+ *
+ * @return true if no entry is indexed
+ */
+bool PluginIndex::empty() const
+{
+  return m_entries.empty();
+}
+
+
+/**
+ * Hashes the given (type, name) key (FNV-1a).
+ */
+std::uint64_t PluginIndex::Hash(const char *type, std::size_t typeLength,
+                                const char *name, std::size_t nameLength)
+{
+  std::uint64_t hash = 14695981039346656037ULL;
+  for (std::size_t i = 0; i < typeLength; ++i) {
+    hash = (hash ^ static_cast<unsigned char>(type[i])) * 1099511628211ULL;
+  }
+  // Separator, so that ("ab", "c") and ("a", "bc") differ
+  hash = (hash ^ 0xff) * 1099511628211ULL;
+  for (std::size_t i = 0; i < nameLength; ++i) {
+    hash = (hash ^ static_cast<unsigned char>(name[i])) * 1099511628211ULL;
+  }
+  return hash;
+}
+
+
+/**
+ * Places the given entry in the hash table, which must have a free slot.
+ */
+void PluginIndex::place(std::uint64_t hash, PluginEntry *pluginEntry)
+{
+  std::size_t mask = m_slots.size() - 1;
+  std::size_t i = static_cast<std::size_t>(hash) & mask;
+  while (nullptr != m_slots[i].entry) {
+    i = (i + 1) & mask;
+  }
+  m_slots[i].hash = hash;
+  m_slots[i].entry = pluginEntry;
+}
+
+
+/**
+ * Doubles the hash table capacity.
+ */
+void PluginIndex::grow()
+{
+  std::vector<Slot> slots;
+  slots.swap(m_slots);
+
+  Slot empty = { 0, nullptr };
+  m_slots.assign(2 * slots.size(), empty);
+  for (auto &slot : slots) {
+    if (nullptr != slot.entry) {
+      place(slot.hash, slot.entry);
+    }
+  }
+}
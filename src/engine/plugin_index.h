@@ -0,0 +1,108 @@
+#ifndef PLUGIN_INDEX_H
+#define PLUGIN_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "plugin_entry.h"
+
+/**
+ * A flat, open-addressing hash table of plugin entries keyed by (type, name).
+ * Lookups take raw character ranges, so they neither allocate nor mutate the
+ * index, and are therefore safe to run concurrently once the index is built.
+ * The index owns its entries.
+ */
+class PluginIndex
+{
+public:
+
+  /**
+   * Constructor.
+   */
+  PluginIndex();
+
+  /**
+   * Destructor.
+   * Deletes all indexed entries.
+   */
+  ~PluginIndex();
+
+  /**
+   * Adds the given entry to the index, which takes ownership of it.
+   *
+   * @param pluginEntry The plugin entry to add
+   *
+   * @return true if the entry was added, or false if an entry with the same
+   *         type and name already exists (ownership stays with the caller)
+   */
+  bool insert(PluginEntry *pluginEntry);
+
+  /**
+   * Finds the entry with the specified type and name.
+   *
+   * @param type The plugin type characters
+   * @param typeLength The plugin type length
+   * @param name The plugin name characters
+   * @param nameLength The plugin name length
+   *
+   * @return The plugin entry, or nullptr
+   */
+  PluginEntry *find(const char *type, std::size_t typeLength,
+                    const char *name, std::size_t nameLength) const;
+
+  /**
+   * Gets all indexed entries, ordered by type and name.
+   *
+   * @return The indexed entries
+   */
+  const std::vector<PluginEntry*> &getAll() const;
+
+  /**
+   * Checks whether the index is empty.
+   *
+   * @return true if no entry is indexed
+   */
+  bool empty() const;
+
+private:
+
+  /**
+   * A hash table slot; an empty slot has a null entry.
+   */
+  struct Slot
+  {
+    std::uint64_t hash;
+    PluginEntry *entry;
+  };
+
+  /**
+   * Hashes the given (type, name) key (FNV-1a).
+   */
+  static std::uint64_t Hash(const char *type, std::size_t typeLength,
+                            const char *name, std::size_t nameLength);
+
+  /**
+   * Places the given entry in the hash table, which must have a free slot.
+   */
+  void place(std::uint64_t hash, PluginEntry *pluginEntry);
+
+  /**
+   * Doubles the hash table capacity.
+   */
+  void grow();
+
+  PluginIndex(const PluginIndex&);
+  PluginIndex &operator=(const PluginIndex&);
+
+  /**
+   * The indexed entries, ordered by type and name.
+   */
+  std::vector<PluginEntry*> m_entries;
+
+  /**
+   * The hash table, whose size is a power of two.
+   */
+  std::vector<Slot> m_slots;
+};
+
+#endif // PLUGIN_INDEX_H
@@ -0,0 +1,160 @@
+#include "plugin_manifest.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include "nlohmann/json.hpp"
+
+using json = nlohmann::json;
+
+/**
+ * The manifest layout version; manifests with another version are ignored.
+ */
+#define PLUGIN_MANIFEST_VERSION 2
+
+/**
+ * Loads the manifest from the specified file.
+ * A missing or malformed file results in an empty manifest.
+ *
+ * @param path The manifest file path
+ *
+ * @return true if the manifest was loaded, otherwise false
+ */
+bool PluginManifest::load(const std::string &path)
+{
+  m_entries.clear();
+
+  std::ifstream file(path.c_str());
+  if (!file) {
+    return false;
+  }
+
+  try {
+    json manifest = json::parse(file);
+    if (PLUGIN_MANIFEST_VERSION != manifest.at("version").get<int>()) {
+      return false;
+    }
+    for (auto &plugin : manifest.at("plugins")) {
+      PluginManifestEntry entry;
+      entry.libPath = plugin.at("libPath").get<std::string>();
+      entry.libName = plugin.at("libName").get<std::string>();
+      entry.size = plugin.at("size").get<uint64_t>();
+      entry.mtimeSec = plugin.at("mtimeSec").get<int64_t>();
+      entry.mtimeNsec = plugin.at("mtimeNsec").get<int64_t>();
+      entry.inode = plugin.at("inode").get<uint64_t>();
+      entry.buildId = plugin.at("buildId").get<std::string>();
+      entry.type = plugin.at("type").get<std::string>();
+      entry.name = plugin.at("name").get<std::string>();
+      entry.version = plugin.at("version").get<std::string>();
+      entry.valid = plugin.at("valid").get<bool>();
+      m_entries[entry.libPath] = entry;
+    }
+  }
+  catch (const json::exception &e) {
+    std::cerr << "Ignoring malformed plugin manifest '" << path << "': " << e.what() << std::endl;
+    m_entries.clear();
+    return false;
+  }
+  return true;
+}
+
+
+/**
+ * Saves the manifest to the specified file, atomically replacing it.
+ *
+ * @param path The manifest file path
+ *
+ * @return true in success, otherwise false
+ */
+bool PluginManifest::save(const std::string &path) const
+{
+  json plugins = json::array();
+  for (auto &element : m_entries) {
+    const PluginManifestEntry &entry = element.second;
+    json plugin;
+    plugin["libPath"] = entry.libPath;
+    plugin["libName"] = entry.libName;
+    plugin["size"] = entry.size;
+    plugin["mtimeSec"] = entry.mtimeSec;
+    plugin["mtimeNsec"] = entry.mtimeNsec;
+    plugin["inode"] = entry.inode;
+    plugin["buildId"] = entry.buildId;
+    plugin["type"] = entry.type;
+    plugin["name"] = entry.name;
+    plugin["version"] = entry.version;
+    plugin["valid"] = entry.valid;
+    plugins.push_back(plugin);
+  }
+
+  json manifest;
+  manifest["version"] = PLUGIN_MANIFEST_VERSION;
+  manifest["plugins"] = plugins;
+
+  // Write a temporary file first, so that readers never see a partial one
+  std::string temporaryPath = path + ".tmp";
+  {
+    std::ofstream file(temporaryPath.c_str(), std::ios::trunc);
+    if (!file) {
+      std::cerr << "Cannot write plugin manifest '" << temporaryPath << "'" << std::endl;
+      return false;
+    }
+    file << manifest.dump(2) << std::endl;
+    if (!file) {
+      std::remove(temporaryPath.c_str());
+      return false;
+    }
+  }
+  if (0 != std::rename(temporaryPath.c_str(), path.c_str())) {
+    std::cerr << "Cannot replace plugin manifest '" << path << "'" << std::endl;
+    std::remove(temporaryPath.c_str());
+    return false;
+  }
+  return true;
+}
+
+
+/**
+ * Finds the cached entry of the specified library.
+ *
+ * @param libPath The plugin library path
+ *
+ * @return The cached entry, or nullptr
+ */
+const PluginManifestEntry *PluginManifest::find(const std::string &libPath) const
+{
+  std::map<std::string, PluginManifestEntry>::const_iterator entry = m_entries.find(libPath);
+  if (entry == m_entries.end()) {
+    return nullptr;
+  }
+  return &entry->second;
+}
+
+
+/**
+ * Adds or replaces the cached entry of a library.
+ *
+ * @param entry The entry to cache
+ */
+void PluginManifest::set(const PluginManifestEntry &entry)
+{
+  m_entries[entry.libPath] = entry;
+}
+
+
+/**
+ * Removes all cached entries.
+ */
+void PluginManifest::clear()
+{
+  m_entries.clear();
+}
+
+
+/**
+ * Gets the number of cached entries.
+ *
+ * @return The number of cached entries
+ */
+std::size_t PluginManifest::size() const
+{
+  return m_entries.size();
+}
@@ -0,0 +1,124 @@
+#ifndef PLUGIN_MANIFEST_H
+#define PLUGIN_MANIFEST_H
+
+#include <cstddef>
+#include <map>
+#include <stdint.h>
+#include <string>
+
+/**
+ * The cached probe outcome of a single plugin library, together with the
+ * file signature it is valid for.
+ */
+struct PluginManifestEntry
+{
+  /**
+   * Constructor.
+   */
+  PluginManifestEntry()
+    : size(0)
+    , mtimeSec(0)
+    , mtimeNsec(0)
+    , inode(0)
+    , valid(false)
+  {
+  }
+
+  /**
+   * Checks whether the file signature matches the given one.
+   *
+   * @param other The entry holding the signature to compare with
+   *
+   * @return true if the library file is unchanged
+   */
+  bool hasSameSignature(const PluginManifestEntry &other) const
+  {
+    return size == other.size
+        && mtimeSec == other.mtimeSec
+        && mtimeNsec == other.mtimeNsec
+        && inode == other.inode;
+  }
+
+  std::string libPath;
+  std::string libName;
+  uint64_t size;
+  int64_t mtimeSec;
+  int64_t mtimeNsec;
+  uint64_t inode;
+  std::string buildId;
+  std::string type;
+  std::string name;
+  std::string version;
+
+  /**
+   * Whether the library turned out to be a valid plugin. Invalid libraries
+   * are cached too, so that they are not probed again either.
+   */
+  bool valid;
+};
+
+
+/**
+ * The on-disk cache of plugin probe outcomes, which lets the plugin registry
+ * skip probing libraries that did not change since the previous start.
+ */
+class PluginManifest
+{
+public:
+
+  /**
+   * Loads the manifest from the specified file.
+   * A missing or malformed file results in an empty manifest.
+   *
+   * @param path The manifest file path
+   *
+   * @return true if the manifest was loaded, otherwise false
+   */
+  bool load(const std::string &path);
+
+  /**
+   * Saves the manifest to the specified file, atomically replacing it.
+   *
+   * @param path The manifest file path
+   *
+   * @return true in success, otherwise false
+   */
+  bool save(const std::string &path) const;
+
+  /**
+   * Finds the cached entry of the specified library.
+   *
+   * @param libPath The plugin library path
+   *
+   * @return The cached entry, or nullptr
+   */
+  const PluginManifestEntry *find(const std::string &libPath) const;
+
+  /**
+   * Adds or replaces the cached entry of a library.
+   *
+   * @param entry The entry to cache
+   */
+  void set(const PluginManifestEntry &entry);
+
+  /**
+   * Removes all cached entries.
+   */
+  void clear();
+
+  /**
+   * Gets the number of cached entries.
+   *
+   * @return The number of cached entries
+   */
+  std::size_t size() const;
+
+private:
+
+  /**
+   * The cached entries, by library path.
+   */
+  std::map<std::string, PluginManifestEntry> m_entries;
+};
+
+#endif // PLUGIN_MANIFEST_H
@@ -0,0 +1,283 @@
+#include "plugin_pool.h"
+#include "plugin_registry.h"
+
+/**
+ * Constructor.
+ *
+ * @param config The retention settings
+ */
+PluginPool::PluginPool(const PluginPoolConfig &config)
+  : m_config(config)
+  , m_registryGeneration(PluginRegistry::getSharedInstance().getGeneration())
+{
+}
+
+
+/**
+ * Destructor.
+ * Resident plugins are left to the plugin registry, which unloads them
+ * upon its own destruction.
+ */
+PluginPool::~PluginPool()
+{
+}
+
+
+/**
+ * Borrows the instance of the specified plugin, loading it if needed.
+ *
+ * @param pluginEntry Pointer to the corresponding plugin entry
+ *
+ * @return A pointer to the plugin instance, or nullptr
+ */
+void *PluginPool::acquire(PluginEntry *pluginEntry)
+{
+  if (nullptr == pluginEntry) {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  std::map<PluginEntry*, Slot>::iterator slot = lookup(pluginEntry);
+  if (slot == m_slots.end()) {
+    return nullptr;
+  }
+
+  ++slot->second.borrowCount;
+
+  // Make room for a newly loaded instance, if a resident limit is set
+  if (m_config.maxResident > 0 && m_slots.size() > m_config.maxResident) {
+    enforceRetention(Clock::now());
+  }
+
+  return slot->second.plugin;
+}
+
+
+/**
+ * Pins the instance of the specified plugin, loading it if needed.
+ * A pinned instance is neither evicted nor cleared; it stays resident until
+ * the plugin registry is reinitialized or destroyed.
+ *
+ * @param pluginEntry Pointer to the corresponding plugin entry
+ *
+ * @return A pointer to the plugin instance, or nullptr
+ */
+void *PluginPool::pin(PluginEntry *pluginEntry)
+{
+  if (nullptr == pluginEntry) {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  std::map<PluginEntry*, Slot>::iterator slot = lookup(pluginEntry);
+  if (slot == m_slots.end()) {
+    return nullptr;
+  }
+
+  slot->second.pinned = true;
+
+  if (m_config.maxResident > 0 && m_slots.size() > m_config.maxResident) {
+    enforceRetention(Clock::now());
+  }
+
+  return slot->second.plugin;
+}
+
+
+/**
+ * Returns a previously borrowed plugin instance to the pool.
+ *
+ * @param pluginEntry Pointer to the corresponding plugin entry
+ */
+void PluginPool::release(PluginEntry *pluginEntry)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  std::map<PluginEntry*, Slot>::iterator slot = m_slots.find(pluginEntry);
+  if (slot == m_slots.end() || 0 == slot->second.borrowCount) {
+    // Either never borrowed, or dropped by a registry reinitialization
+    return;
+  }
+
+  --slot->second.borrowCount;
+
+  // Timestamps are only needed to expire idle instances
+  if (m_config.idleTimeout.count() > 0) {
+    Clock::time_point now = Clock::now();
+    slot->second.lastUsed = now;
+    enforceRetention(now);
+  }
+}
+
+
+/**
+ * Unloads all idle instances that exceeded the idle timeout.
+ */
+void PluginPool::evictIdle()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  enforceRetention(Clock::now());
+}
+
+
+/**
+ * Unloads all resident instances that are neither borrowed nor pinned.
+ */
+void PluginPool::clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  std::map<PluginEntry*, Slot>::iterator slot = m_slots.begin();
+  while (slot != m_slots.end()) {
+    std::map<PluginEntry*, Slot>::iterator next = slot;
+    ++next;
+    if (isEvictable(slot->second)) {
+      unload(slot);
+    }
+    slot = next;
+  }
+}
+
+
+/**
+ * Sets the retention settings and applies them to the resident instances.
+ *
+ * @param config The retention settings
+ */
+void PluginPool::setConfig(const PluginPoolConfig &config)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_config = config;
+  enforceRetention(Clock::now());
+}
+
+
+/**
+ * Gets the retention settings.
+ *
+ * @return The retention settings
+ */
+PluginPoolConfig PluginPool::getConfig() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_config;
+}
+
+
+/**
+ * Gets the pool counters.
+ *
+ * @return A snapshot of the pool counters
+ */
+PluginPoolStats PluginPool::getStats() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_stats;
+}
+
+
+/**
+ * Looks up the specified plugin, loading it if it is not resident.
+ * Must be called with the pool mutex held.
+ *
+ * @param pluginEntry Pointer to the corresponding plugin entry
+ *
+ * @return Iterator to the corresponding slot, or the end iterator
+ */
+std::map<PluginEntry*, PluginPool::Slot>::iterator PluginPool::lookup(PluginEntry *pluginEntry)
+{
+  // A reinitialized registry has already unloaded every instance we hold
+  unsigned long generation = PluginRegistry::getSharedInstance().getGeneration();
+  if (generation != m_registryGeneration) {
+    m_slots.clear();
+    m_lru.clear();
+    m_stats.resident = 0;
+    m_registryGeneration = generation;
+  }
+
+  // Fast path: the plugin is already resident
+  std::map<PluginEntry*, Slot>::iterator slot = m_slots.find(pluginEntry);
+  if (slot != m_slots.end()) {
+    m_lru.splice(m_lru.begin(), m_lru, slot->second.lruPosition);
+    ++m_stats.hits;
+    return slot;
+  }
+
+  // Slow path: go through the dynamic loader
+  ++m_stats.misses;
+  void *plugin = PluginRegistry::getSharedInstance().loadPlugin(pluginEntry);
+  if (nullptr == plugin) {
+    return m_slots.end();
+  }
+
+  Slot newSlot;
+  newSlot.plugin = plugin;
+  newSlot.borrowCount = 0;
+  newSlot.pinned = false;
+  newSlot.lastUsed = Clock::now();
+  newSlot.lruPosition = m_lru.insert(m_lru.begin(), pluginEntry);
+  slot = m_slots.insert(std::make_pair(pluginEntry, newSlot)).first;
+  m_stats.resident = m_slots.size();
+
+  return slot;
+}
+
+
+/**
+ * Unloads instances until the retention settings are satisfied.
+ * Must be called with the pool mutex held.
+ *
+ * @param now The current time
+ */
+void PluginPool::enforceRetention(Clock::time_point now)
+{
+  // Expire idle instances, starting from the least recently used one
+  if (m_config.idleTimeout.count() > 0) {
+    std::list<PluginEntry*>::iterator position = m_lru.end();
+    while (position != m_lru.begin()) {
+      --position;
+      std::map<PluginEntry*, Slot>::iterator slot = m_slots.find(*position);
+      if (!isEvictable(slot->second)) {
+        continue;
+      }
+      if (now - slot->second.lastUsed < m_config.idleTimeout) {
+        continue;
+      }
+      ++position;
+      ++m_stats.evictions;
+      unload(slot);
+    }
+  }
+
+  // Enforce the resident limit, starting from the least recently used one
+  if (m_config.maxResident > 0) {
+    std::list<PluginEntry*>::iterator position = m_lru.end();
+    while (m_slots.size() > m_config.maxResident && position != m_lru.begin()) {
+      --position;
+      std::map<PluginEntry*, Slot>::iterator slot = m_slots.find(*position);
+      if (!isEvictable(slot->second)) {
+        continue;
+      }
+      ++position;
+      ++m_stats.evictions;
+      unload(slot);
+    }
+  }
+}
+
+
+/**
+ * Unloads the specified resident instance.
+ * Must be called with the pool mutex held.
+ *
+ * @param slot Iterator to the corresponding slot
+ */
+void PluginPool::unload(std::map<PluginEntry*, Slot>::iterator slot)
+{
+  PluginRegistry::getSharedInstance().unloadPlugin(slot->first);
+  m_lru.erase(slot->second.lruPosition);
+  m_slots.erase(slot);
+  m_stats.resident = m_slots.size();
+}
@@ -0,0 +1,247 @@
+#ifndef PLUGIN_POOL_H
+#define PLUGIN_POOL_H
+
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <map>
+#include <mutex>
+#include "plugin_entry.h"
+
+/**
+ * The retention settings of the plugin pool.
+ * With the default settings, every loaded plugin stays resident (pinned)
+ * until the pool is cleared.
+ */
+struct PluginPoolConfig
+{
+  /**
+   * Constructor.
+   */
+  PluginPoolConfig()
+    : maxResident(0)
+    , idleTimeout(0)
+  {
+  }
+
+  /**
+   * The maximum number of resident plugin instances, or 0 for no limit.
+   * When the limit is exceeded, the least recently used idle instance
+   * is unloaded.
+   */
+  std::size_t maxResident;
+
+  /**
+   * The time after which an idle plugin instance is unloaded, or 0 to keep
+   * idle instances forever.
+   */
+  std::chrono::milliseconds idleTimeout;
+};
+
+
+/**
+ * The plugin pool counters.
+ */
+struct PluginPoolStats
+{
+  /**
+   * Constructor.
+   */
+  PluginPoolStats()
+    : hits(0)
+    , misses(0)
+    , evictions(0)
+    , resident(0)
+  {
+  }
+
+  /**
+   * The number of acquisitions served by a resident instance.
+   */
+  std::size_t hits;
+
+  /**
+   * The number of acquisitions that had to load the plugin.
+   */
+  std::size_t misses;
+
+  /**
+   * The number of instances unloaded due to the retention settings.
+   */
+  std::size_t evictions;
+
+  /**
+   * The number of currently resident instances.
+   */
+  std::size_t resident;
+};
+
+
+/**
+ * Keeps plugin instances resident between operations, so that steady-state
+ * calls do not go through the dynamic loader. Plugins are borrowed with
+ * acquire() and returned with release(); an instance is never unloaded while
+ * it is borrowed.
+ */
+class PluginPool
+{
+public:
+
+  /**
+   * Constructor.
+   *
+   * @param config The retention settings
+   */
+  explicit PluginPool(const PluginPoolConfig &config = PluginPoolConfig());
+
+  /**
+   * Destructor.
+   * Resident plugins are left to the plugin registry, which unloads them
+   * upon its own destruction.
+   */
+  ~PluginPool();
+
+  /**
+   * Borrows the instance of the specified plugin, loading it if needed.
+   *
+   * @param pluginEntry Pointer to the corresponding plugin entry
+   *
+   * @return A pointer to the plugin instance, or nullptr
+   */
+  void *acquire(PluginEntry *pluginEntry);
+
+  /**
+   * Pins the instance of the specified plugin, loading it if needed.
+   * A pinned instance is neither evicted nor cleared; it stays resident until
+   * the plugin registry is reinitialized or destroyed.
+   *
+   * @param pluginEntry Pointer to the corresponding plugin entry
+   *
+   * @return A pointer to the plugin instance, or nullptr
+   */
+  void *pin(PluginEntry *pluginEntry);
+
+  /**
+   * Returns a previously borrowed plugin instance to the pool.
+   *
+   * @param pluginEntry Pointer to the corresponding plugin entry
+   */
+  void release(PluginEntry *pluginEntry);
+
+  /**
+   * Unloads all idle instances that exceeded the idle timeout.
+   */
+  void evictIdle();
+
+  /**
+   * Unloads all resident instances that are neither borrowed nor pinned.
+   */
+  void clear();
+
+  /**
+   * Sets the retention settings and applies them to the resident instances.
+   *
+   * @param config The retention settings
+   */
+  void setConfig(const PluginPoolConfig &config);
+
+  /**
+   * Gets the retention settings.
+   *
+   * @return The retention settings
+   */
+  PluginPoolConfig getConfig() const;
+
+  /**
+   * Gets the pool counters.
+   *
+   * @return A snapshot of the pool counters
+   */
+  PluginPoolStats getStats() const;
+
+private:
+
+  typedef std::chrono::steady_clock Clock;
+
+  /**
+   * A resident plugin instance.
+   */
+  struct Slot
+  {
+    void *plugin;
+    unsigned borrowCount;
+    bool pinned;
+    Clock::time_point lastUsed;
+    std::list<PluginEntry*>::iterator lruPosition;
+  };
+
+  /**
+   * Looks up the specified plugin, loading it if it is not resident.
+   * Must be called with the pool mutex held.
+   *
+   * @param pluginEntry Pointer to the corresponding plugin entry
+   *
+   * @return Iterator to the corresponding slot, or the end iterator
+   */
+  std::map<PluginEntry*, Slot>::iterator lookup(PluginEntry *pluginEntry);
+
+  /**
+   * Checks whether the specified slot may be unloaded.
+   *
+   * @param slot The slot to check
+   *
+   * @return true if the slot is neither borrowed nor pinned
+   */
+  static bool isEvictable(const Slot &slot)
+  {
+    return 0 == slot.borrowCount && !slot.pinned;
+  }
+
+  /**
+   * Unloads instances until the retention settings are satisfied.
+   * Must be called with the pool mutex held.
+   *
+   * @param now The current time
+   */
+  void enforceRetention(Clock::time_point now);
+
+  /**
+   * Unloads the specified resident instance.
+   * Must be called with the pool mutex held.
+   *
+   * @param slot Iterator to the corresponding slot
+   */
+  void unload(std::map<PluginEntry*, Slot>::iterator slot);
+
+  /**
+   * The retention settings.
+   */
+  PluginPoolConfig m_config;
+
+  /**
+   * The pool counters.
+   */
+  PluginPoolStats m_stats;
+
+  /**
+   * The resident instances.
+   */
+  std::map<PluginEntry*, Slot> m_slots;
+
+  /**
+   * The resident plugins, most recently used first.
+   */
+  std::list<PluginEntry*> m_lru;
+
+  /**
+   * The plugin registry generation the resident instances belong to.
+   */
+  unsigned long m_registryGeneration;
+
+  /**
+   * Guards the pool state.
+   */
+  mutable std::mutex m_mutex;
+};
+
+#endif // PLUGIN_POOL_H
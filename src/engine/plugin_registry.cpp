@@ -1,19 +1,177 @@
 #include "plugin_registry.h"
 #include "plugin_utils.h"
+#include "plugin_manifest.h"
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdlib>
+#include <chrono>
 #include <iostream>
+#include <thread>
 
 /**
- * This is where the plugin registry expects to find the solidMediaEngine 
- * plugins. Each plugin corresponds to a .so file located under this directory.
+ * This is where the plugin registry expects to find the plugins, unless
+ * told otherwise. Each plugin corresponds to a .so file located under this
+ * directory. The build points it to the plugins install directory.
  */
-#define PLUGINS_HOMEDIR "/home/michaelp/Desktop/calculator/plugins"
+#ifndef PLUGINS_HOMEDIR
+#define PLUGINS_HOMEDIR "plugins"
+#endif
+
+/**
+ * The environment variable that overrides the default plugin search
+ * directories (colon-separated).
+ */
+#define PLUGIN_PATH_ENV "CALCULATOR_PLUGIN_PATH"
+
+/**
+ * The file name suffix of plugin libraries; other files are not probed.
+ */
+#define PLUGIN_LIB_SUFFIX ".so"
+
+/**
+ * This is where the plugin registry caches the probe outcomes of the plugin
+ * libraries between runs. The build points it next to the plugins install
+ * directory.
+ */
+#ifndef PLUGIN_MANIFEST_PATH
+#define PLUGIN_MANIFEST_PATH "plugin_manifest.json"
+#endif
+
+/**
+ * The outcome of probing a plugin library.
+ */
+struct PluginRegistry::ProbeResult
+{
+  ProbeResult()
+    : dirFd(-1)
+    , searchOrder(0)
+    , cached(false)
+    , probeTime(0)
+  {
+  }
+
+  int dirFd;
+  std::size_t searchOrder;
+  PluginManifestEntry record;
+  bool cached;
+  std::chrono::microseconds probeTime;
+};
+
+
+/**
+ * Checks whether the given file name has the plugin library suffix.
+ */
+static bool HasPluginLibSuffix(const char *fileName)
+{
+  std::size_t length = std::strlen(fileName);
+  std::size_t suffixLength = sizeof(PLUGIN_LIB_SUFFIX) - 1;
+  return length > suffixLength
+      && 0 == std::memcmp(fileName + length - suffixLength, PLUGIN_LIB_SUFFIX, suffixLength);
+}
+
+
+/**
+ * Opens the specified plugin library in order to resolve its metadata.
+ * Safe to call concurrently for different libraries.
+ *
+ * @param result The probe result, whose directory and library must be set
+ */
+void PluginRegistry::ProbePluginLibrary(ProbeResult *result)
+{
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  PluginManifestEntry &record = result->record;
+  record.buildId = PluginUtils::ReadBuildId(result->dirFd, record.libName);
+
+  // Preferably, read the metadata straight from the file: this neither maps
+  // the library into the process nor runs any of its code
+  PluginMetadata metadata;
+  if (PluginUtils::ReadPluginMetadata(result->dirFd, record.libName, &metadata)) {
+    record.type = metadata.type;
+    record.name = metadata.name;
+    record.version = metadata.version;
+    record.valid = !record.type.empty() && !record.name.empty();
+    result->probeTime = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+    return;
+  }
+
+  // Legacy plugins have to be loaded and instantiated.
+  // Start reading the file asynchronously, so that probes waiting on cold
+  // storage overlap even though the dynamic loader serializes dlopen calls
+  int fd = openat(result->dirFd, record.libName.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd >= 0) {
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    close(fd);
+  }
+
+  // Open plugin library, by path so that the loader does not search for it
+  void *lib = PluginUtils::OpenPluginLibrary(record.libPath);
+  if (nullptr != lib) {
+    // Create plugin instance in order to resolve its metadata.
+    void *plugin = PluginUtils::CreatePlugin(lib);
+    if (nullptr != plugin) {
+      // Resolve the plugin type and name
+      record.type = PluginUtils::GetPluginType(lib);
+      record.name = PluginUtils::GetPluginName(lib);
+      record.valid = !record.type.empty() && !record.name.empty();
+
+      // Destroy plugin instance
+      PluginUtils::DestroyPlugin(lib, plugin);
+    }
+
+    // Close plugin library
+    PluginUtils::ClosePluginLibrary(lib);
+  }
+
+  result->probeTime = std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - start);
+}
+
+
+/**
+ * Gets the default plugin search directories.
+ *
+ * @return The directories listed in CALCULATOR_PLUGIN_PATH, or the
+ *         build-time default plugin directory
+ */
+std::vector<std::string> PluginRegistry::GetDefaultSearchPaths()
+{
+  std::vector<std::string> paths;
+  const char *pluginPath = getenv(PLUGIN_PATH_ENV);
+  if (nullptr != pluginPath) {
+    std::string value = pluginPath;
+    std::size_t begin = 0;
+    while (begin <= value.size()) {
+      std::size_t end = value.find(':', begin);
+      if (std::string::npos == end) {
+        end = value.size();
+      }
+      if (end > begin) {
+        paths.push_back(value.substr(begin, end - begin));
+      }
+      begin = end + 1;
+    }
+  }
+  if (paths.empty()) {
+    paths.push_back(PLUGINS_HOMEDIR);
+  }
+  return paths;
+}
+
 
 /**
  * Constructor.
  */
 PluginRegistry::PluginRegistry()
+  : m_index(new PluginIndex())
+  , m_generation(0)
+  , m_discoveryConcurrency(0)
+  , m_searchPaths(GetDefaultSearchPaths())
+  , m_manifestPath(PLUGIN_MANIFEST_PATH)
 {
 }
 
@@ -24,108 +182,295 @@ PluginRegistry::PluginRegistry()
 PluginRegistry::~PluginRegistry()
 {
   std::cout << "Clearing plugin registry" << std::endl;
-  std::map<std::string, std::map<std::string, PluginEntry*>>::const_iterator pluginType;
-  for (pluginType = m_entries.begin(); pluginType != m_entries.end(); ++pluginType) {
-    std::map<std::string, PluginEntry*> entries = pluginType->second;
-    std::map<std::string, PluginEntry*>::const_iterator pluginEntryIter;
-    for (pluginEntryIter = entries.begin(); pluginEntryIter != entries.end(); ++pluginEntryIter) {
-      unloadPlugin(pluginEntryIter->second);
-      delete pluginEntryIter->second;
-    }
-    entries.clear();
+  std::lock_guard<std::mutex> lock(m_writerMutex);
+  clear();
+
+  // No reader can outlive the registry, so all indexes can be freed now
+  for (auto index : m_retiredIndexes) {
+    delete index;
+  }
+  m_retiredIndexes.clear();
+  delete m_index.load(std::memory_order_acquire);
+}
+
+
+/**
+ * Unloads all loaded plugins and discards all plugin entries.
+ * Must be called with the writer mutex held.
+ */
+void PluginRegistry::clear()
+{
+  while (!m_pluginLibMap.empty()) {
+    std::string pluginId = m_pluginLibMap.begin()->first;
+    unloadPluginLocked(pluginId);
   }
-  m_entries.clear();
+  publish(new PluginIndex());
+}
+
+
+/**
+ * Publishes the given index to readers and retires the current one.
+ * Must be called with the writer mutex held.
+ *
+ * @param index The index to publish
+ */
+void PluginRegistry::publish(const PluginIndex *index)
+{
+  const PluginIndex *retired = m_index.exchange(index, std::memory_order_acq_rel);
+  m_retiredIndexes.push_back(retired);
 }
 
 
 /**
  * Initializes the plugin registry.
+ * If the registry was already initialized, all loaded plugins are unloaded
+ * and all previously discovered plugin entries are discarded first.
+ * Plugin libraries are probed in parallel (see setDiscoveryConcurrency),
+ * while entries are registered in search directory and library name order.
+ * Libraries that did not change since they were recorded in the plugin
+ * manifest are not probed.
  */
 void PluginRegistry::initialize()
 {
-  // By convention, the plugin registry expects that all plugin .so libraries 
-  // are located under the specified folder
-  std::string pluginsDir = PLUGINS_HOMEDIR;
-  DIR* dirp = opendir(pluginsDir.c_str());
-  if (NULL == dirp) {
-    std::cerr << "Could not open directory: " << pluginsDir << std::endl;
-    return;
-  }
+  initialize(false);
+}
 
-  struct dirent * dp;
 
-  // Loop for each plugin library found at the specified folder
-  std::cout << "Traversing directory " << pluginsDir << std::endl;
-  while ((dp = readdir(dirp)) != nullptr) {
-    std::string libname = dp->d_name;
+/**
+ * Initializes the plugin registry.
+ * If the registry was already initialized, all loaded plugins are unloaded
+ * and all previously discovered plugin entries are discarded first.
+ * Plugin libraries are probed in parallel (see setDiscoveryConcurrency),
+ * while entries are registered in search directory and library name order.
+ *
+ * @param rescan true to probe all libraries, ignoring the plugin manifest
+ */
+void PluginRegistry::initialize(bool rescan)
+{
+  std::lock_guard<std::mutex> lock(m_writerMutex);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
 
-    // Make sure to avoid '.' and '..' entries
-    if (libname == "." || libname == "..") {
-      continue;
-    }
+  // Invalidate everything that was handed out under the previous generation
+  m_generation.fetch_add(1, std::memory_order_acq_rel);
+  clear();
 
-    std::string fullpath = libname;
-    std::cout << "Attempting to open lib " << fullpath << " ..." << std::endl;
+  // Readers keep using the (empty) published index until discovery ends
+  PluginIndex *index = new PluginIndex();
 
-    // Open plugin library
-    void *lib = PluginUtils::OpenPluginLibrary(fullpath);
-    if (nullptr == lib) {
-      continue;
-    }
+  // Load the probe outcomes of the previous run, if any
+  PluginManifest manifest;
+  if (!rescan && !m_manifestPath.empty()) {
+    manifest.load(m_manifestPath);
+  }
 
-    // Create plugin instance in order to resolve its metadata.
-    void *plugin = PluginUtils::CreatePlugin(lib);
-    if (nullptr == plugin) {
-      PluginUtils::ClosePluginLibrary(lib);
+  // Collect the plugin libraries found at the search directories. These are
+  // kept open until probing ends, so that libraries are opened relative to
+  // them rather than resolving the full path again
+  std::vector<DIR*> directories;
+  std::vector<ProbeResult> results;
+  std::vector<std::size_t> pending;
+  for (std::size_t searchOrder = 0; searchOrder < m_searchPaths.size(); ++searchOrder) {
+    const std::string &pluginsDir = m_searchPaths[searchOrder];
+    int dirFd = open(pluginsDir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    DIR *dirp = dirFd < 0 ? nullptr : fdopendir(dirFd);
+    if (nullptr == dirp) {
+      std::cerr << "Could not open directory: " << pluginsDir << std::endl;
+      if (dirFd >= 0) {
+        close(dirFd);
+      }
       continue;
     }
+    directories.push_back(dirp);
+
+    std::cout << "Traversing directory " << pluginsDir << std::endl;
+    struct dirent *dp;
+    while ((dp = readdir(dirp)) != nullptr) {
+      // Skip everything that cannot be a plugin library without a syscall
+      if (!HasPluginLibSuffix(dp->d_name)
+          || (DT_REG != dp->d_type && DT_LNK != dp->d_type && DT_UNKNOWN != dp->d_type)) {
+        continue;
+      }
+
+      struct stat st;
+      if (0 != fstatat(dirFd, dp->d_name, &st, 0) || !S_ISREG(st.st_mode)) {
+        continue;
+      }
+
+      ProbeResult result;
+      result.dirFd = dirFd;
+      result.searchOrder = searchOrder;
+      result.record.libName = dp->d_name;
+      result.record.libPath = pluginsDir + "/" + result.record.libName;
+      result.record.size = static_cast<uint64_t>(st.st_size);
+      result.record.mtimeSec = static_cast<int64_t>(st.st_mtim.tv_sec);
+      result.record.mtimeNsec = static_cast<int64_t>(st.st_mtim.tv_nsec);
+      result.record.inode = static_cast<uint64_t>(st.st_ino);
+
+      // Reuse the cached outcome if the library did not change
+      const PluginManifestEntry *cached = manifest.find(result.record.libPath);
+      if (nullptr != cached && cached->hasSameSignature(result.record)) {
+        result.record = *cached;
+        result.cached = true;
+      }
+      results.push_back(result);
+    }
+  }
 
-    // Resolve the plugin type
-    std::string pluginType = PluginUtils::GetPluginType(lib);
-    if (pluginType.empty()) {
-      PluginUtils::ClosePluginLibrary(lib);
-      continue;
+  // Sort by search directory and library name, so the outcome does not
+  // depend on directory order
+  std::sort(results.begin(), results.end(),
+            [](const ProbeResult &a, const ProbeResult &b) {
+              if (a.searchOrder != b.searchOrder) {
+                return a.searchOrder < b.searchOrder;
+              }
+              return a.record.libName < b.record.libName;
+            });
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    if (!results[i].cached) {
+      pending.push_back(i);
     }
+  }
 
-    // Resolve the plugin name
-    std::string pluginName = PluginUtils::GetPluginName(lib);
-    if (pluginName.empty()) {
-      PluginUtils::ClosePluginLibrary(lib);
-      continue;
+  // Probe the new or changed libraries in parallel
+  unsigned concurrency = m_discoveryConcurrency;
+  if (0 == concurrency) {
+    concurrency = std::max(1u, std::thread::hardware_concurrency());
+  }
+  concurrency = static_cast<unsigned>(std::min<std::size_t>(concurrency, pending.size()));
+
+  std::atomic<std::size_t> next(0);
+  auto worker = [&]() {
+    for (std::size_t i = next++; i < pending.size(); i = next++) {
+      ProbePluginLibrary(&results[pending[i]]);
     }
+  };
+
+  std::vector<std::thread> workers;
+  for (unsigned i = 1; i < concurrency; ++i) {
+    workers.push_back(std::thread(worker));
+  }
+  worker();
+  for (auto &thread : workers) {
+    thread.join();
+  }
+  for (auto dirp : directories) {
+    closedir(dirp);
+  }
 
-    // Destroy plugin instance
-    PluginUtils::DestroyPlugin(lib, plugin);
+  // Register the discovered plugins, in search directory and library name
+  // order; a plugin found in more than one directory is taken from the first
+  PluginManifest updatedManifest;
+  for (auto &result : results) {
+    const PluginManifestEntry &record = result.record;
+    updatedManifest.set(record);
 
-    // Close plugin library
-    PluginUtils::ClosePluginLibrary(lib);
+    if (result.cached) {
+      std::cout << "Found lib " << record.libPath << " in plugin manifest" << std::endl;
+    }
+    else {
+      std::cout << "Probed lib " << record.libPath
+                << " in " << result.probeTime.count() << " us" << std::endl;
+    }
+    if (!record.valid) {
+      continue;
+    }
 
     // Create the corresponding plugin entry and populate its properties
     // Then, add the plugin entry to the registry
-    PluginEntry *pluginEntry = new PluginEntry(pluginType, pluginName, libname);
-    std::pair<std::string, PluginEntry*> p(pluginName, pluginEntry);
-    m_entries[pluginType].insert(p);
+    PluginEntry *pluginEntry = new PluginEntry(record.type, record.name, record.libName, record.libPath);
+    pluginEntry->setVersion(record.version);
+    pluginEntry->setProbeTime(result.probeTime);
+    if (!index->insert(pluginEntry)) {
+      std::cout << "Skipped lib " << record.libPath << ": plugin (type=" << record.type
+                << ", name=" << record.name << ") is already registered" << std::endl;
+      delete pluginEntry;
+      continue;
+    }
+
+    std::cout << "Added plugin (type=" << record.type << ", name=" << record.name << ")" << std::endl;
+  }
+
+  publish(index);
 
-    std::cout << "Added plugin (type=" << pluginType << ", name=" << pluginName << ")" << std::endl;
+  // Persist the manifest if anything was probed or removed
+  std::size_t cachedCount = results.size() - pending.size();
+  if (!m_manifestPath.empty() && (!pending.empty() || cachedCount != manifest.size())) {
+    updatedManifest.save(m_manifestPath);
   }
 
-  free(dp);
-  closedir(dirp);
+  std::cout << "Plugin discovery took "
+            << std::chrono::duration_cast<std::chrono::microseconds>(
+                 std::chrono::steady_clock::now() - start).count()
+            << " us (" << cachedCount << " cached, " << pending.size() << " probed)" << std::endl;
 }
 
 
 /**
- * Discovers the plugin with specified type and name.
+ * Sets the directories searched for plugin libraries upon initialization,
+ * replacing the default ones. Directories are searched in order; if the
+ * same plugin is found in more than one, the first one wins.
  *
- * @param type The desired plugin type
- * @param name The desired plugin name
+ * By default, the directories are taken from the CALCULATOR_PLUGIN_PATH
+ * environment variable (colon-separated) or, if that is not set, from the
+ * directory the plugins are installed to by the build.
  *
- * @return A plugin entry corresponding to the dicsovered plugin, or nullptr
+ * @param paths The plugin search directories
  */
-PluginEntry *PluginRegistry::get(std::string type, std::string name)
+void PluginRegistry::setSearchPaths(const std::vector<std::string> &paths)
 {
-  std::map<std::string, PluginEntry*> m = m_entries[type];
-  return m[name];
+  std::lock_guard<std::mutex> lock(m_writerMutex);
+  m_searchPaths = paths;
+}
+
+
+/**
+ * Appends a directory to the ones searched for plugin libraries.
+ *
+ * @param path The plugin search directory
+ */
+void PluginRegistry::addSearchPath(const std::string &path)
+{
+  std::lock_guard<std::mutex> lock(m_writerMutex);
+  m_searchPaths.push_back(path);
+}
+
+
+/**
+ * Gets the directories searched for plugin libraries.
+ *
+ * @return The plugin search directories, in search order
+ */
+std::vector<std::string> PluginRegistry::getSearchPaths()
+{
+  std::lock_guard<std::mutex> lock(m_writerMutex);
+  return m_searchPaths;
+}
+
+
+/**
+ * Sets the path of the plugin manifest, which caches the probe outcomes of
+ * the plugin libraries between runs.
+ *
+ * @param path The manifest file path, or an empty string to disable caching
+ */
+void PluginRegistry::setManifestPath(const std::string &path)
+{
+  std::lock_guard<std::mutex> lock(m_writerMutex);
+  m_manifestPath = path;
+}
+
+
+/**
+ * Sets the maximum number of plugin libraries probed in parallel upon
+ * initialization.
+ *
+ * @param concurrency The maximum number of parallel probes, or 0 to use
+ *                    one probe per hardware thread
+ */
+void PluginRegistry::setDiscoveryConcurrency(unsigned concurrency)
+{
+  std::lock_guard<std::mutex> lock(m_writerMutex);
+  m_discoveryConcurrency = concurrency;
 }
 
 
@@ -135,16 +480,9 @@ PluginEntry *PluginRegistry::get(std::string type, std::string name)
  * @return A vector that contains pointers to the PluginEntry instances
  *         corresponding to the registered plugins
  */
-std::vector<PluginEntry*> PluginRegistry::getAll()
+std::vector<PluginEntry*> PluginRegistry::getAll() const
 {
-  std::vector<PluginEntry*> result;
-  for (auto element : m_entries) {
-    std::map<std::string, PluginEntry*> map = element.second;
-    for (auto entry : map) {
-      result.push_back(entry.second);
-    }
-  }
-  return result;
+  return m_index.load(std::memory_order_acquire)->getAll();
 }
 
 
@@ -161,22 +499,29 @@ void *PluginRegistry::loadPlugin(PluginEntry *pluginEntry)
     return nullptr;
   }
 
-  std::string pluginId = pluginEntry->getId();
+  std::lock_guard<std::mutex> lock(m_writerMutex);
+
+  const std::string &pluginId = pluginEntry->getId();
 
   // Check if there is already a handle for this plugin
-  if (nullptr != m_pluginHandleMap[pluginId]) {
-    return m_pluginHandleMap[pluginId];
+  std::map<std::string, void*>::const_iterator handle = m_pluginHandleMap.find(pluginId);
+  if (handle != m_pluginHandleMap.end()) {
+    return handle->second;
   }
 
   // Open plugin library
-  std::cout << "Loading library " << pluginEntry->getLibName() << std::endl;
-  void *lib = PluginUtils::OpenPluginLibrary(pluginEntry->getLibName());
+  std::cout << "Loading library " << pluginEntry->getLibPath() << std::endl;
+  void *lib = PluginUtils::OpenPluginLibrary(pluginEntry->getLibPath());
   if (!lib) {
     return nullptr;
   }
 
   // Create and return Operation plugin instance
   void *plugin = PluginUtils::CreatePlugin(lib);
+  if (!plugin) {
+    PluginUtils::ClosePluginLibrary(lib);
+    return nullptr;
+  }
 
   // Add handles to internal maps for reuse
   m_pluginHandleMap[pluginId] = plugin;
@@ -197,19 +542,103 @@ void PluginRegistry::unloadPlugin(PluginEntry *pluginEntry)
       return;
   }
 
-  std::string pluginId = pluginEntry->getId();
+  std::lock_guard<std::mutex> lock(m_writerMutex);
+  unloadPluginLocked(pluginEntry->getId());
+}
 
-  void *plugin = m_pluginHandleMap[pluginId];
-  void *lib = m_pluginLibMap[pluginId];
 
-  if (nullptr != lib) {
-    if (nullptr != plugin) {
-      PluginUtils::DestroyPlugin(lib, plugin);
-      m_pluginHandleMap.erase(m_pluginHandleMap.find(pluginId));
+/**
+ * Creates an additional instance of the specified plugin, for callers that
+ * need an instance of their own (e.g. one per thread). The plugin must be
+ * loaded; the instance is destroyed by destroyPluginInstance, or when the
+ * plugin is unloaded, whichever comes first.
+ *
+ * @param pluginEntry Pointer to the corresponding plugin entry
+ *
+ * @return A pointer to the new plugin instance, or nullptr if the plugin
+ *         is not loaded
+ */
+void *PluginRegistry::createPluginInstance(PluginEntry *pluginEntry)
+{
+  if (nullptr == pluginEntry) {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(m_writerMutex);
+
+  const std::string &pluginId = pluginEntry->getId();
+  std::map<std::string, void*>::const_iterator lib = m_pluginLibMap.find(pluginId);
+  if (lib == m_pluginLibMap.end()) {
+    return nullptr;
+  }
+
+  void *plugin = PluginUtils::CreatePlugin(lib->second);
+  if (nullptr != plugin) {
+    m_pluginInstanceMap.insert(std::make_pair(pluginId, plugin));
+  }
+  return plugin;
+}
+
+
+/**
+ * Destroys an instance created by createPluginInstance.
+ *
+ * @param pluginEntry Pointer to the corresponding plugin entry
+ * @param plugin The plugin instance
+ */
+void PluginRegistry::destroyPluginInstance(PluginEntry *pluginEntry, void *plugin)
+{
+  if (nullptr == pluginEntry || nullptr == plugin) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(m_writerMutex);
+
+  const std::string &pluginId = pluginEntry->getId();
+  std::map<std::string, void*>::const_iterator lib = m_pluginLibMap.find(pluginId);
+  if (lib == m_pluginLibMap.end()) {
+    // Already destroyed along with the plugin
+    return;
+  }
+
+  auto range = m_pluginInstanceMap.equal_range(pluginId);
+  for (auto instance = range.first; instance != range.second; ++instance) {
+    if (instance->second == plugin) {
+      PluginUtils::DestroyPlugin(lib->second, plugin);
+      m_pluginInstanceMap.erase(instance);
+      return;
     }
+  }
+}
 
-    PluginUtils::ClosePluginLibrary(lib);
-    m_pluginLibMap.erase(m_pluginLibMap.find(pluginId));
-    std::cout << "Plugin with id = " << pluginId << " successfully unloaded" << std::endl;
+
+/**
+ * Unloads the plugin with the given id.
+ * Must be called with the writer mutex held.
+ *
+ * @param pluginId The plugin id
+ */
+void PluginRegistry::unloadPluginLocked(const std::string &pluginId)
+{
+  std::map<std::string, void*>::iterator lib = m_pluginLibMap.find(pluginId);
+  if (lib == m_pluginLibMap.end()) {
+    return;
   }
-}
\ No newline at end of file
+
+  // Additional instances must go before the library they were created from
+  auto range = m_pluginInstanceMap.equal_range(pluginId);
+  for (auto instance = range.first; instance != range.second; ++instance) {
+    PluginUtils::DestroyPlugin(lib->second, instance->second);
+  }
+  m_pluginInstanceMap.erase(range.first, range.second);
+
+  std::map<std::string, void*>::iterator plugin = m_pluginHandleMap.find(pluginId);
+  if (plugin != m_pluginHandleMap.end()) {
+    PluginUtils::DestroyPlugin(lib->second, plugin->second);
+    m_pluginHandleMap.erase(plugin);
+  }
+
+  PluginUtils::ClosePluginLibrary(lib->second);
+  m_pluginLibMap.erase(lib);
+  std::cout << "Plugin with id = " << pluginId << " successfully unloaded" << std::endl;
+}
@@ -1,14 +1,28 @@
 #ifndef PLUGIN_REGISTRY_H
 #define PLUGIN_REGISTRY_H
 
+#include <atomic>
+#include <cstring>
 #include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 #include "plugin_entry.h"
+#include "plugin_index.h"
 
 /**
  * Implements the plugin registry, which is used to register, discover, and 
  * load/unload plugins.
+ *
+ * The registry is safe to use from multiple threads. Lookups (get, getAll)
+ * never block: they read an immutable index of the registered entries,
+ * which writers (initialize) replace atomically. Replaced indexes, which
+ * own their entries, are retired rather than freed, so that entry pointers
+ * handed out to concurrent readers stay valid for the lifetime of the
+ * registry.
+ * Writers, as well as plugin loading and unloading, are serialized.
+ * Reinitializing the registry unloads all plugins, so it must not race with
+ * operations that are still executing plugin code.
  */
 class PluginRegistry
 {
@@ -34,18 +48,137 @@ public:
 
   /**
    * Initializes the plugin registry.
+   * If the registry was already initialized, all loaded plugins are unloaded
+   * and all previously discovered plugin entries are discarded first.
+   * Plugin libraries are probed in parallel (see setDiscoveryConcurrency),
+   * while entries are registered in search directory and library name order.
+   * Libraries that did not change since they were recorded in the plugin
+   * manifest are not probed.
    */
   void initialize();
 
+  /**
+   * Initializes the plugin registry.
+   * If the registry was already initialized, all loaded plugins are unloaded
+   * and all previously discovered plugin entries are discarded first.
+   * Plugin libraries are probed in parallel (see setDiscoveryConcurrency),
+   * while entries are registered in search directory and library name order.
+   *
+   * @param rescan true to probe all libraries, ignoring the plugin manifest
+   */
+  void initialize(bool rescan);
+
+  /**
+   * Sets the directories searched for plugin libraries upon initialization,
+   * replacing the default ones. Directories are searched in order; if the
+   * same plugin is found in more than one, the first one wins.
+   *
+   * By default, the directories are taken from the CALCULATOR_PLUGIN_PATH
+   * environment variable (colon-separated) or, if that is not set, from the
+   * directory the plugins are installed to by the build.
+   *
+   * @param paths The plugin search directories
+   */
+  void setSearchPaths(const std::vector<std::string> &paths);
+
+  /**
+   * Appends a directory to the ones searched for plugin libraries.
+   *
+   * @param path The plugin search directory
+   */
+  void addSearchPath(const std::string &path);
+
+  /**
+   * Gets the directories searched for plugin libraries.
+   *
+   * @return The plugin search directories, in search order
+   */
+  std::vector<std::string> getSearchPaths();
+
+  /**
+   * Sets the path of the plugin manifest, which caches the probe outcomes of
+   * the plugin libraries between runs.
+   *
+   * @param path The manifest file path, or an empty string to disable caching
+   */
+  void setManifestPath(const std::string &path);
+
+  /**
+   * Sets the maximum number of plugin libraries probed in parallel upon
+   * initialization.
+   *
+   * @param concurrency The maximum number of parallel probes, or 0 to use
+   *                    one probe per hardware thread
+   */
+  void setDiscoveryConcurrency(unsigned concurrency);
+
+  /**
+   * Gets the registry generation, which changes every time the registry is
+   * (re)initialized. Plugin entries and instances obtained under a previous
+   * generation are no longer valid.
+   *
+   * @return The registry generation
+   */
+  unsigned long getGeneration() const
+  {
+    return m_generation.load(std::memory_order_acquire);
+  }
+
+  /**
+   * Gets the address of the registry generation counter, so that holders of
+   * cached plugin instances can cheaply check whether these are still valid.
+   *
+   * @return The address of the registry generation counter
+   */
+  const std::atomic<unsigned long> *getGenerationCounter() const
+  {
+    return &m_generation;
+  }
+
+  /**
+   * Discovers the plugin with specified type and name.
+   * The lookup neither allocates nor modifies the registry.
+   *
+   * @param type The desired plugin type
+   * @param typeLength The length of the desired plugin type
+   * @param name The desired plugin name
+   * @param nameLength The length of the desired plugin name
+   *
+   * @return A plugin entry corresponding to the dicsovered plugin, or nullptr
+   */
+  PluginEntry *get(const char *type, std::size_t typeLength,
+                   const char *name, std::size_t nameLength) const
+  {
+    return m_index.load(std::memory_order_acquire)->find(type, typeLength, name, nameLength);
+  }
+
   /**
    * Discovers the plugin with specified type and name.
+   * The lookup neither allocates nor modifies the registry.
    *
    * @param type The desired plugin type
    * @param name The desired plugin name
    *
    * @return A plugin entry corresponding to the dicsovered plugin, or nullptr
    */
-  PluginEntry *get(std::string type, std::string name);
+  PluginEntry *get(const std::string &type, const std::string &name) const
+  {
+    return get(type.data(), type.size(), name.data(), name.size());
+  }
+
+  /**
+   * Discovers the plugin with specified type and name.
+   * The lookup neither allocates nor modifies the registry.
+   *
+   * @param type The desired plugin type (null-terminated)
+   * @param name The desired plugin name (null-terminated)
+   *
+   * @return A plugin entry corresponding to the dicsovered plugin, or nullptr
+   */
+  PluginEntry *get(const char *type, const char *name) const
+  {
+    return get(type, std::strlen(type), name, std::strlen(name));
+  }
 
   /**
    * Gets all registered plugin entries.
@@ -53,7 +186,7 @@ public:
    * @return A vector that contains pointers to the PluginEntry instances
    *         corresponding to the registered plugins
    */
-  std::vector<PluginEntry*> getAll();
+  std::vector<PluginEntry*> getAll() const;
 
   /**
    * Loads the specified plugin.
@@ -71,17 +204,92 @@ public:
    */
   void unloadPlugin(PluginEntry *pluginEntry);
 
+  /**
+   * Creates an additional instance of the specified plugin, for callers that
+   * need an instance of their own (e.g. one per thread). The plugin must be
+   * loaded; the instance is destroyed by destroyPluginInstance, or when the
+   * plugin is unloaded, whichever comes first.
+   *
+   * @param pluginEntry Pointer to the corresponding plugin entry
+   *
+   * @return A pointer to the new plugin instance, or nullptr if the plugin
+   *         is not loaded
+   */
+  void *createPluginInstance(PluginEntry *pluginEntry);
+
+  /**
+   * Destroys an instance created by createPluginInstance.
+   *
+   * @param pluginEntry Pointer to the corresponding plugin entry
+   * @param plugin The plugin instance
+   */
+  void destroyPluginInstance(PluginEntry *pluginEntry, void *plugin);
+
 private:
 
+  /**
+   * The outcome of probing a plugin library during discovery.
+   */
+  struct ProbeResult;
+
+  /**
+   * Opens the specified plugin library in order to resolve its metadata.
+   * Safe to call concurrently for different libraries.
+   *
+   * @param result The probe result, whose directory and library must be set
+   */
+  static void ProbePluginLibrary(ProbeResult *result);
+
+  /**
+   * Gets the default plugin search directories.
+   *
+   * @return The directories listed in CALCULATOR_PLUGIN_PATH, or the
+   *         build-time default plugin directory
+   */
+  static std::vector<std::string> GetDefaultSearchPaths();
+
   /**
    * Constructor.
    */
   PluginRegistry();
 
   /**
-   * The plugin registry entries.
+   * Unloads all loaded plugins and discards all plugin entries.
+   * Must be called with the writer mutex held.
+   */
+  void clear();
+
+  /**
+   * Publishes the given index to readers and retires the current one.
+   * Must be called with the writer mutex held.
+   *
+   * @param index The index to publish
    */
-  std::map<std::string, std::map<std::string, PluginEntry*>> m_entries;
+  void publish(const PluginIndex *index);
+
+  /**
+   * Unloads the plugin with the given id.
+   * Must be called with the writer mutex held.
+   *
+   * @param pluginId The plugin id
+   */
+  void unloadPluginLocked(const std::string &pluginId);
+
+  /**
+   * The currently published plugin registry entries.
+   */
+  std::atomic<const PluginIndex*> m_index;
+
+  /**
+   * The indexes replaced so far, which are kept alive until the registry
+   * is destroyed since concurrent readers may still use their entries.
+   */
+  std::vector<const PluginIndex*> m_retiredIndexes;
+
+  /**
+   * Serializes writers, as well as plugin loading and unloading.
+   */
+  std::mutex m_writerMutex;
 
   /**
    * The map of plugin handles.
@@ -92,6 +300,31 @@ private:
    * The map of plugin lib handles.
    */
   std::map<std::string, void*> m_pluginLibMap;
+
+  /**
+   * The additional plugin instances (see createPluginInstance).
+   */
+  std::multimap<std::string, void*> m_pluginInstanceMap;
+
+  /**
+   * The registry generation.
+   */
+  std::atomic<unsigned long> m_generation;
+
+  /**
+   * The maximum number of parallel probes during discovery (0 = automatic).
+   */
+  unsigned m_discoveryConcurrency;
+
+  /**
+   * The plugin search directories.
+   */
+  std::vector<std::string> m_searchPaths;
+
+  /**
+   * The plugin manifest file path (empty = no caching).
+   */
+  std::string m_manifestPath;
 };
 
 #endif // PLUGIN_REGISTRY_H
\ No newline at end of file
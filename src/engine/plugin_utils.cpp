@@ -1,8 +1,124 @@
 #include "plugin_utils.h"
 #include <dlfcn.h>
+#include <elf.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <iostream>
 
 
+/**
+ * Locates the named section within the given mapped ELF image.
+ *
+ * @param image The mapped ELF image
+ * @param size The image size
+ * @param name The section name
+ * @param sectionOffset Receives the section offset within the image
+ * @param sectionSize Receives the section size
+ *
+ * @return true in success, otherwise false
+ */
+template <typename Ehdr, typename Shdr>
+static bool FindSection(const unsigned char *image, size_t size, const char *name,
+                        size_t *sectionOffset, size_t *sectionSize)
+{
+  if (size < sizeof(Ehdr)) {
+    return false;
+  }
+  const Ehdr *header = reinterpret_cast<const Ehdr *>(image);
+
+  // Bounds-check the section header table and the section name table
+  if (header->e_shentsize != sizeof(Shdr) || header->e_shoff > size
+      || header->e_shnum > (size - header->e_shoff) / sizeof(Shdr)
+      || header->e_shstrndx >= header->e_shnum) {
+    return false;
+  }
+  const Shdr *sections = reinterpret_cast<const Shdr *>(image + header->e_shoff);
+  const Shdr &names = sections[header->e_shstrndx];
+  if (names.sh_offset > size || names.sh_size > size - names.sh_offset) {
+    return false;
+  }
+  const char *nameTable = reinterpret_cast<const char *>(image + names.sh_offset);
+  size_t nameSize = strlen(name) + 1;
+
+  for (size_t i = 0; i < header->e_shnum; ++i) {
+    const Shdr &section = sections[i];
+    if (section.sh_name >= names.sh_size
+        || names.sh_size - section.sh_name < nameSize
+        || 0 != memcmp(nameTable + section.sh_name, name, nameSize)) {
+      continue;
+    }
+    if (section.sh_type == SHT_NOBITS || section.sh_offset > size
+        || section.sh_size > size - section.sh_offset) {
+      return false;
+    }
+    *sectionOffset = section.sh_offset;
+    *sectionSize = section.sh_size;
+    return true;
+  }
+  return false;
+}
+
+
+/**
+ * Maps the ELF file located at the specified path and locates the named
+ * section within it. Only the pages actually touched (the headers and the
+ * section) are read from disk.
+ *
+ * @param dirFd The directory relative paths are resolved against
+ * @param path The ELF file path
+ * @param name The section name
+ * @param section Receives a copy of the section contents
+ *
+ * @return true in success, otherwise false
+ */
+static bool ReadElfSection(int dirFd, const std::string &path, const char *name, std::string *section)
+{
+  int fd = openat(dirFd, path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat st;
+  if (0 != fstat(fd, &st) || st.st_size < EI_NIDENT) {
+    close(fd);
+    return false;
+  }
+
+  size_t size = static_cast<size_t>(st.st_size);
+  void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (MAP_FAILED == mapping) {
+    return false;
+  }
+
+  const unsigned char *image = static_cast<const unsigned char *>(mapping);
+  size_t sectionOffset = 0;
+  size_t sectionSize = 0;
+  bool found = false;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  const unsigned char hostData = ELFDATA2LSB;
+#else
+  const unsigned char hostData = ELFDATA2MSB;
+#endif
+  if (0 == memcmp(image, ELFMAG, SELFMAG) && hostData == image[EI_DATA]) {
+    if (ELFCLASS64 == image[EI_CLASS]) {
+      found = FindSection<Elf64_Ehdr, Elf64_Shdr>(image, size, name, &sectionOffset, &sectionSize);
+    }
+    else if (ELFCLASS32 == image[EI_CLASS]) {
+      found = FindSection<Elf32_Ehdr, Elf32_Shdr>(image, size, name, &sectionOffset, &sectionSize);
+    }
+  }
+  if (found) {
+    section->assign(reinterpret_cast<const char *>(image + sectionOffset), sectionSize);
+  }
+  munmap(mapping, size);
+  return found;
+}
+
+
 /**
  * Opens the plugin library located at the specified path.
  * 
@@ -145,4 +261,108 @@ bool PluginUtils::DestroyPlugin(void *pluginLib, void *plugin)
   }
   destroy(plugin);
   return true;
-}
\ No newline at end of file
+}
+
+
+/**
+ * Reads the metadata of the plugin library located at the specified path
+ * straight from its PLUGIN_METADATA_SECTION ELF section, without loading
+ * the library.
+ *
+ * @param path The plugin library path
+ * @param metadata Receives the plugin metadata
+ *
+ * @return true in success, or false if the library does not declare its
+ *         metadata (or is not a valid ELF file)
+ */
+bool PluginUtils::ReadPluginMetadata(const std::string &path, PluginMetadata *metadata)
+{
+  return ReadPluginMetadata(AT_FDCWD, path, metadata);
+}
+
+
+/**
+ * Reads the metadata of the plugin library located at the specified path,
+ * relative to the given directory, straight from its PLUGIN_METADATA_SECTION
+ * ELF section, without loading the library.
+ *
+ * @param dirFd The open directory relative paths are resolved against
+ * @param path The plugin library path
+ * @param metadata Receives the plugin metadata
+ *
+ * @return true in success, or false if the library does not declare its
+ *         metadata (or is not a valid ELF file)
+ */
+bool PluginUtils::ReadPluginMetadata(int dirFd, const std::string &path, PluginMetadata *metadata)
+{
+  std::string section;
+  if (!ReadElfSection(dirFd, path, PLUGIN_METADATA_SECTION, &section)
+      || section.size() < sizeof(PluginMetadata)) {
+    return false;
+  }
+
+  memcpy(metadata, section.data(), sizeof(PluginMetadata));
+  if (PLUGIN_METADATA_MAGIC != metadata->magic
+      || PLUGIN_METADATA_ABI_VERSION != metadata->abiVersion) {
+    return false;
+  }
+
+  // Never trust the strings to be terminated
+  metadata->type[PLUGIN_METADATA_STRING_SIZE - 1] = '\0';
+  metadata->name[PLUGIN_METADATA_STRING_SIZE - 1] = '\0';
+  metadata->version[PLUGIN_METADATA_STRING_SIZE - 1] = '\0';
+  return true;
+}
+
+
+/**
+ * Reads the GNU build-id of the library located at the specified path,
+ * without loading the library.
+ *
+ * @param path The library path
+ *
+ * @return The build-id as a hex string, or an empty string
+ */
+std::string PluginUtils::ReadBuildId(const std::string &path)
+{
+  return ReadBuildId(AT_FDCWD, path);
+}
+
+
+/**
+ * Reads the GNU build-id of the library located at the specified path,
+ * relative to the given directory, without loading the library.
+ *
+ * @param dirFd The open directory relative paths are resolved against
+ * @param path The library path
+ *
+ * @return The build-id as a hex string, or an empty string
+ */
+std::string PluginUtils::ReadBuildId(int dirFd, const std::string &path)
+{
+  std::string section;
+  if (!ReadElfSection(dirFd, path, ".note.gnu.build-id", &section)) {
+    return std::string();
+  }
+
+  // The note header is laid out the same way for 32 and 64-bit ELF files
+  Elf64_Nhdr note;
+  if (section.size() < sizeof(note)) {
+    return std::string();
+  }
+  memcpy(&note, section.data(), sizeof(note));
+  size_t descOffset = sizeof(note) + ((note.n_namesz + 3) & ~3u);
+  if (NT_GNU_BUILD_ID != note.n_type || descOffset > section.size()
+      || note.n_descsz > section.size() - descOffset) {
+    return std::string();
+  }
+
+  static const char digits[] = "0123456789abcdef";
+  std::string buildId;
+  for (size_t i = 0; i < note.n_descsz; ++i) {
+    unsigned char byte = static_cast<unsigned char>(section[descOffset + i]);
+    buildId += digits[byte >> 4];
+    buildId += digits[byte & 0xf];
+  }
+  return buildId;
+}
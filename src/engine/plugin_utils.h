@@ -2,6 +2,7 @@
 #define PLUGIN_UTILS_H
 
 #include <string>
+#include "plugin_metadata.h"
 
 /**
  * This class provides various plugin-related utility methods.
@@ -64,6 +65,54 @@ public:
    */
   static bool DestroyPlugin(void *pluginLib, void *plugin);
 
+  /**
+   * Reads the metadata of the plugin library located at the specified path
+   * straight from its PLUGIN_METADATA_SECTION ELF section, without loading
+   * the library.
+   *
+   * @param path The plugin library path
+   * @param metadata Receives the plugin metadata
+   *
+   * @return true in success, or false if the library does not declare its
+   *         metadata (or is not a valid ELF file)
+   */
+  static bool ReadPluginMetadata(const std::string &path, PluginMetadata *metadata);
+
+  /**
+   * Reads the metadata of the plugin library located at the specified path,
+   * relative to the given directory, straight from its PLUGIN_METADATA_SECTION
+   * ELF section, without loading the library.
+   *
+   * @param dirFd The open directory relative paths are resolved against
+   * @param path The plugin library path
+   * @param metadata Receives the plugin metadata
+   *
+   * @return true in success, or false if the library does not declare its
+   *         metadata (or is not a valid ELF file)
+   */
+  static bool ReadPluginMetadata(int dirFd, const std::string &path, PluginMetadata *metadata);
+
+  /**
+   * Reads the GNU build-id of the library located at the specified path,
+   * without loading the library.
+   *
+   * @param path The library path
+   *
+   * @return The build-id as a hex string, or an empty string
+   */
+  static std::string ReadBuildId(const std::string &path);
+
+  /**
+   * Reads the GNU build-id of the library located at the specified path,
+   * relative to the given directory, without loading the library.
+   *
+   * @param dirFd The open directory relative paths are resolved against
+   * @param path The library path
+   *
+   * @return The build-id as a hex string, or an empty string
+   */
+  static std::string ReadBuildId(int dirFd, const std::string &path);
+
   typedef void *createInstance_t();
   typedef void destroyInstance_t(void*);
   typedef const char *getType_t();
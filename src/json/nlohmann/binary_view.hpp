@@ -0,0 +1,550 @@
+#pragma once
+
+#include <cstddef> // size_t
+#include <cstdint> // uint8_t, int64_t, uint64_t
+#include <cstring> // memcmp, strlen
+#include <string> // string, to_string
+#include <type_traits> // enable_if, is_arithmetic
+#include <vector> // vector
+
+#include <nlohmann/detail/macro_scope.hpp>
+#include <nlohmann/detail/exceptions.hpp>
+#include <nlohmann/detail/input/input_adapters.hpp>
+#include <nlohmann/detail/input/binary_cursor.hpp>
+#include <nlohmann/detail/typed_array.hpp>
+
+namespace nlohmann
+{
+/*!
+@brief a read-only view of a data item of a CBOR or MessagePack buffer
+
+Where @ref basic_json::from_cbor and @ref basic_json::from_msgpack decode a
+whole buffer, a binary_view decodes nothing up front: it reads the header of
+its item, and looks elements and members up in the original buffer when they
+are accessed. Strings are not copied (see @ref data), and looking up a member
+or an element returns another view.
+
+The positions of the elements of an array (or of the members of an object)
+are recorded as the container is first scanned, up to the element accessed,
+so that subsequent accesses to those elements cost a single step; a lookup of
+a missing key scans the whole object once.
+
+@note The buffer must outlive the view and all views derived from it.
+@note Looking elements up updates the recorded positions, so a view must not
+      be shared between threads without synchronization. Copies of a view
+      record positions independently.
+
+Example:
+@code
+auto request = nlohmann::binary_view::from_cbor(bytes.data(), bytes.size());
+double factor = request.at("factor").get<double>();
+auto values = request.at("values");
+for (std::size_t i = 0; i < values.size(); ++i)
+{
+    sum += values[i].get<double>();
+}
+@endcode
+*/
+class binary_view
+{
+  public:
+    /// the type of a data item
+    using item_type = detail::binary_cursor::item_type;
+
+    /// an invalid view (see @ref valid)
+    binary_view() = default;
+
+    /*!
+    @brief create a view of the CBOR item at the beginning of a buffer
+
+    @param[in] data  the buffer
+    @param[in] size  the size of the buffer, in bytes
+
+    @return the view; invalid if the item header is malformed or truncated
+    */
+    static binary_view from_cbor(const std::uint8_t* data, const std::size_t size)
+    {
+        return binary_view(detail::input_format_t::cbor, data, data, data + size);
+    }
+
+    static binary_view from_cbor(const std::vector<std::uint8_t>& buffer)
+    {
+        return from_cbor(buffer.data(), buffer.size());
+    }
+
+    /*!
+    @brief create a view of the MessagePack item at the beginning of a buffer
+
+    @param[in] data  the buffer
+    @param[in] size  the size of the buffer, in bytes
+
+    @return the view; invalid if the item header is malformed or truncated
+    */
+    static binary_view from_msgpack(const std::uint8_t* data, const std::size_t size)
+    {
+        return binary_view(detail::input_format_t::msgpack, data, data, data + size);
+    }
+
+    static binary_view from_msgpack(const std::vector<std::uint8_t>& buffer)
+    {
+        return from_msgpack(buffer.data(), buffer.size());
+    }
+
+    /////////////////////
+    // type inspection //
+    /////////////////////
+
+    /// return whether the view refers to a (well-formed) item; lookups of
+    /// missing keys or elements return invalid views
+    bool valid() const noexcept
+    {
+        return m_valid;
+    }
+
+    /// return the type of the item (null for invalid views)
+    item_type type() const noexcept
+    {
+        return m_item.type;
+    }
+
+    bool is_null() const noexcept
+    {
+        return m_valid and m_item.type == item_type::null;
+    }
+
+    bool is_boolean() const noexcept
+    {
+        return m_item.type == item_type::boolean;
+    }
+
+    bool is_number() const noexcept
+    {
+        return is_number_integer() or is_number_float();
+    }
+
+    bool is_number_integer() const noexcept
+    {
+        return m_item.type == item_type::number_integer or m_item.type == item_type::number_unsigned;
+    }
+
+    bool is_number_unsigned() const noexcept
+    {
+        return m_item.type == item_type::number_unsigned;
+    }
+
+    bool is_number_float() const noexcept
+    {
+        return m_item.type == item_type::number_float;
+    }
+
+    bool is_string() const noexcept
+    {
+        return m_item.type == item_type::string;
+    }
+
+    bool is_binary() const noexcept
+    {
+        return m_item.type == item_type::binary;
+    }
+
+    bool is_array() const noexcept
+    {
+        return m_item.type == item_type::array;
+    }
+
+    bool is_object() const noexcept
+    {
+        return m_item.type == item_type::object;
+    }
+
+    /// return the CBOR tag or the MessagePack extension type of the item, or -1
+    std::int64_t tag() const noexcept
+    {
+        return m_item.tag;
+    }
+
+    /// return the type as string, as @ref basic_json::type_name does
+    const char* type_name() const noexcept
+    {
+        switch (m_item.type)
+        {
+            case item_type::null:
+                return "null";
+            case item_type::boolean:
+                return "boolean";
+            case item_type::string:
+                return "string";
+            case item_type::binary:
+                return "binary";
+            case item_type::array:
+                return "array";
+            case item_type::object:
+                return "object";
+            default:
+                return "number";
+        }
+    }
+
+    ///////////
+    // value //
+    ///////////
+
+    /*!
+    @brief get the value of a boolean or number item
+
+    @throw type_error.302 if the item is not a boolean or a number
+    */
+    template<typename ArithmeticType, typename std::enable_if<
+                 std::is_arithmetic<ArithmeticType>::value, int>::type = 0>
+    ArithmeticType get() const
+    {
+        switch (m_item.type)
+        {
+            case item_type::boolean:
+                return static_cast<ArithmeticType>(m_item.boolean);
+            case item_type::number_integer:
+                return static_cast<ArithmeticType>(m_item.number_integer);
+            case item_type::number_unsigned:
+                return static_cast<ArithmeticType>(m_item.number_unsigned);
+            case item_type::number_float:
+                return static_cast<ArithmeticType>(m_item.number_float);
+            default:
+                JSON_THROW(detail::type_error::create(302, "type must be number, but is " + std::string(type_name())));
+        }
+    }
+
+    /*!
+    @brief get a copy of a string item
+
+    @throw type_error.302 if the item is not a string
+    */
+    template<typename StringType, typename std::enable_if<
+                 std::is_same<StringType, std::string>::value, int>::type = 0>
+    StringType get() const
+    {
+        if (JSON_UNLIKELY(not is_string()))
+        {
+            JSON_THROW(detail::type_error::create(302, "type must be string, but is " + std::string(type_name())));
+        }
+        return StringType(reinterpret_cast<const char*>(m_item.data), m_item.size);
+    }
+
+    /// return the bytes of a string or binary item, within the buffer
+    const std::uint8_t* data() const noexcept
+    {
+        return m_item.data;
+    }
+
+    /*!
+    @brief return the number of bytes of a string or binary item, of elements
+           of an array or of members of an object, or 0 for other items
+
+    The size of an indefinite-length CBOR container is only known once it has
+    been scanned; this scans it.
+    */
+    std::size_t size() const
+    {
+        if (m_item.size == detail::binary_cursor::indefinite_size)
+        {
+            index_until(static_cast<std::size_t>(-1));
+            return m_offsets.size();
+        }
+        return m_item.size;
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    //////////////////
+    // typed arrays //
+    //////////////////
+
+    /// return whether the item is a typed array: a CBOR byte string tagged
+    /// as such (RFC 8746), or a MessagePack extension of type
+    /// @ref detail::msgpack_float64_array_type
+    bool is_typed_array() const noexcept
+    {
+        detail::typed_array_type layout;
+        return get_typed_array_layout(layout);
+    }
+
+    /*!
+    @brief convert the elements of a typed array, or of an array of numbers,
+           to doubles
+
+    Typed arrays of doubles in host byte order are copied at once; other typed
+    arrays are converted element by element, straight from the buffer.
+
+    @param[out] values    receives the elements, up to @a capacity
+    @param[in] capacity   the number of doubles @a values has room for
+
+    @return the number of elements, which may exceed @a capacity
+
+    @throw type_error.302 if the item is neither a typed array nor an array,
+                          or if an element is not a number
+    */
+    std::size_t get_to(double* values, const std::size_t capacity) const
+    {
+        detail::typed_array_type layout;
+        if (get_typed_array_layout(layout))
+        {
+            const std::size_t count = m_item.size / layout.element_size;
+            detail::read_typed_array(layout, m_item.data, (count < capacity) ? count : capacity, values);
+            return count;
+        }
+
+        if (JSON_UNLIKELY(not is_array()))
+        {
+            JSON_THROW(detail::type_error::create(302, "type must be array, but is " + std::string(type_name())));
+        }
+        std::size_t count = 0;
+        for (; index_until(count); ++count)
+        {
+            if (count < capacity)
+            {
+                values[count] = operator[](count).get<double>();
+            }
+        }
+        throw_if_malformed();
+        return count;
+    }
+
+    /*!
+    @brief convert the elements of a typed array, or of an array of numbers,
+           to doubles
+
+    @param[out] values  receives the elements, replacing its contents
+
+    @throw type_error.302 if the item is neither a typed array nor an array,
+                          or if an element is not a number
+    */
+    void get_to(std::vector<double>& values) const
+    {
+        detail::typed_array_type layout;
+        values.resize(get_typed_array_layout(layout) ? m_item.size / layout.element_size : size());
+        values.resize(get_to(values.data(), values.size()));
+    }
+
+    ////////////
+    // arrays //
+    ////////////
+
+    /// return a view of the given element of an array; invalid if out of range
+    binary_view operator[](const std::size_t idx) const
+    {
+        if (not is_array() or not index_until(idx))
+        {
+            return binary_view();
+        }
+        return binary_view(m_format, m_first, m_offsets[idx], m_last);
+    }
+
+    /*!
+    @brief return a view of the given element of an array
+    @throw type_error.304 if the item is not an array
+    @throw out_of_range.401 if the index is out of range
+    */
+    binary_view at(const std::size_t idx) const
+    {
+        if (JSON_UNLIKELY(not is_array()))
+        {
+            JSON_THROW(detail::type_error::create(304, "cannot use at() with " + std::string(type_name())));
+        }
+        binary_view result = operator[](idx);
+        if (JSON_UNLIKELY(not result.valid()))
+        {
+            throw_if_malformed();
+            JSON_THROW(detail::out_of_range::create(401, "array index " + std::to_string(idx) + " is out of range"));
+        }
+        return result;
+    }
+
+    /////////////
+    // objects //
+    /////////////
+
+    /// return a view of the value of the given member; invalid if missing
+    binary_view find(const char* key, const std::size_t length) const
+    {
+        if (not is_object())
+        {
+            return binary_view();
+        }
+        for (std::size_t i = 0; index_until(i); ++i)
+        {
+            detail::binary_cursor cursor(m_format, m_offsets[i], m_last);
+            detail::binary_cursor::item name;
+            if (cursor.read(name) and name.type == item_type::string and name.size == length
+                    and std::memcmp(name.data, key, length) == 0)
+            {
+                return binary_view(m_format, m_first, cursor.position(), m_last);
+            }
+        }
+        return binary_view();
+    }
+
+    binary_view find(const char* key) const
+    {
+        return find(key, std::strlen(key));
+    }
+
+    binary_view find(const std::string& key) const
+    {
+        return find(key.data(), key.size());
+    }
+
+    /// return a view of the value of the given member; invalid if missing
+    binary_view operator[](const std::string& key) const
+    {
+        return find(key);
+    }
+
+    /// return whether the object has a member with the given key
+    bool contains(const std::string& key) const
+    {
+        return find(key).valid();
+    }
+
+    /*!
+    @brief return a view of the value of the given member
+    @throw type_error.304 if the item is not an object
+    @throw out_of_range.403 if there is no such member
+    */
+    binary_view at(const std::string& key) const
+    {
+        if (JSON_UNLIKELY(not is_object()))
+        {
+            JSON_THROW(detail::type_error::create(304, "cannot use at() with " + std::string(type_name())));
+        }
+        binary_view result = find(key);
+        if (JSON_UNLIKELY(not result.valid()))
+        {
+            throw_if_malformed();
+            JSON_THROW(detail::out_of_range::create(403, "key '" + key + "' not found"));
+        }
+        return result;
+    }
+
+    /// return a view of the key of the member at the given index of an
+    /// object, in buffer order; invalid if out of range
+    binary_view key(const std::size_t idx) const
+    {
+        if (not is_object() or not index_until(idx))
+        {
+            return binary_view();
+        }
+        return binary_view(m_format, m_first, m_offsets[idx], m_last);
+    }
+
+    /// return a view of the value of the member at the given index of an
+    /// object, in buffer order; invalid if out of range
+    binary_view value(const std::size_t idx) const
+    {
+        if (not is_object() or not index_until(idx))
+        {
+            return binary_view();
+        }
+        detail::binary_cursor cursor(m_format, m_offsets[idx], m_last);
+        cursor.skip();
+        return binary_view(m_format, m_first, cursor.position(), m_last);
+    }
+
+  private:
+    /// read the header of the item at @a position
+    binary_view(const detail::input_format_t format, const std::uint8_t* first,
+                const std::uint8_t* position, const std::uint8_t* last)
+        : m_format(format), m_first(first), m_last(last)
+    {
+        detail::binary_cursor cursor(format, position, last);
+        m_valid = cursor.read(m_item);
+        if (not m_valid)
+        {
+            m_item = detail::binary_cursor::item();
+        }
+        m_scan = cursor.position();
+    }
+
+    /*!
+    @brief record the positions of the elements (or members) of the container
+           up to the given index
+    @return whether the container has an element at that index
+    */
+    bool index_until(const std::size_t idx) const
+    {
+        const bool indefinite = (m_item.size == detail::binary_cursor::indefinite_size);
+        detail::binary_cursor cursor(m_format, m_scan, m_last);
+        while (m_offsets.size() <= idx and not m_complete)
+        {
+            if (indefinite ? cursor.read_break() : m_offsets.size() == m_item.size)
+            {
+                m_complete = true;
+                break;
+            }
+            const std::uint8_t* position = cursor.position();
+            if (JSON_UNLIKELY(not cursor.skip() or (is_object() and not cursor.skip())))
+            {
+                // the rest of the container cannot be read
+                m_complete = m_malformed = true;
+                break;
+            }
+            m_offsets.push_back(position);
+        }
+        m_scan = cursor.position();
+        return idx < m_offsets.size();
+    }
+
+    /// determine the element layout of a typed array
+    bool get_typed_array_layout(detail::typed_array_type& layout) const noexcept
+    {
+        if (not is_binary())
+        {
+            return false;
+        }
+        if (m_format == detail::input_format_t::msgpack)
+        {
+            if (m_item.tag != detail::msgpack_float64_array_type)
+            {
+                return false;
+            }
+            layout = detail::msgpack_float64_array_layout();
+        }
+        else if (m_item.tag < 0 or not detail::get_cbor_typed_array_type(static_cast<std::uint64_t>(m_item.tag), layout))
+        {
+            return false;
+        }
+        return m_item.size % layout.element_size == 0;
+    }
+
+    /// throw a parse error if the container was found to be malformed
+    void throw_if_malformed() const
+    {
+        if (JSON_UNLIKELY(m_malformed))
+        {
+            JSON_THROW(detail::parse_error::create(110, static_cast<std::size_t>(m_scan - m_first) + 1,
+                                                   "malformed or truncated " + std::string(type_name())));
+        }
+    }
+
+    /// the format of the buffer
+    detail::input_format_t m_format = detail::input_format_t::cbor;
+    /// the beginning of the buffer (for error positions)
+    const std::uint8_t* m_first = nullptr;
+    /// the end of the buffer
+    const std::uint8_t* m_last = nullptr;
+    /// the item header
+    detail::binary_cursor::item m_item {};
+    /// whether the item header could be read
+    bool m_valid = false;
+
+    /// the positions of the elements (for objects: of the keys) found so far
+    mutable std::vector<const std::uint8_t*> m_offsets {};
+    /// the position of the next element to be found
+    mutable const std::uint8_t* m_scan = nullptr;
+    /// whether all elements were found
+    mutable bool m_complete = false;
+    /// whether the container turned out to be malformed
+    mutable bool m_malformed = false;
+};
+}
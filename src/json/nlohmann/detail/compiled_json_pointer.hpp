@@ -0,0 +1,217 @@
+#pragma once
+
+#include <cstddef> // size_t
+#include <limits> // numeric_limits
+#include <string> // string
+#include <vector> // vector
+
+#include <nlohmann/detail/macro_scope.hpp>
+#include <nlohmann/detail/value_t.hpp>
+#include <nlohmann/detail/json_pointer.hpp>
+
+namespace nlohmann
+{
+/*!
+@brief a JSON pointer prepared for repeated lookups
+
+A @ref json_pointer keeps its reference tokens as strings: every resolution
+converts object keys to the key type of the object and parses array indices
+again. A compiled_json_pointer does both once, when it is created, so that
+resolving it against any number of values involves no parsing, no allocation
+and no exception.
+
+Each token is stored both as an object key and, if it is a valid array index
+in the sense of RFC 6901 (digits without a leading zero), as an integer: like
+a @ref json_pointer, a token is applied to an object as a key and to an array
+as an index.
+
+Unlike the accessors taking a @ref json_pointer, @ref find never inserts
+values and never throws: a pointer that cannot be resolved (a missing key,
+an index out of range, the index `-`, or a token applied to a primitive
+value) yields a null pointer.
+
+Example:
+@code
+static const json::compiled_json_pointer factor("/options/scale/0");
+if (const json* value = factor.find(request))
+{
+    ...
+}
+@endcode
+
+@note The objects of @ref basic_json are ordered (`std::map` or @ref
+      flat_map), so members are looked up by comparing keys rather than by
+      hash; the keys are stored in the key type of the objects, so lookups
+      do not convert or copy them.
+*/
+template<typename BasicJsonType>
+class compiled_json_pointer
+{
+    using key_type = typename BasicJsonType::object_t::key_type;
+    using size_type = typename BasicJsonType::size_type;
+
+  public:
+    /*!
+    @brief compile the given JSON pointer
+
+    @param[in] s  string representing the JSON pointer; if omitted, the empty
+                  string is assumed which references the whole JSON value
+
+    @throw parse_error.107 if the given JSON pointer @a s is nonempty and does
+                           not begin with a slash (`/`)
+    @throw parse_error.108 if a tilde (`~`) in the given JSON pointer @a s is
+                           not followed by `0` (representing `~`) or `1`
+                           (representing `/`)
+    */
+    explicit compiled_json_pointer(const std::string& s = "")
+        : compiled_json_pointer(json_pointer<BasicJsonType>(s))
+    {}
+
+    /// compile the given JSON pointer
+    explicit compiled_json_pointer(const json_pointer<BasicJsonType>& ptr)
+        : m_pointer(ptr)
+    {
+        m_tokens.reserve(ptr.reference_tokens.size());
+        for (const auto& reference_token : ptr.reference_tokens)
+        {
+            m_tokens.push_back({key_type(reference_token.begin(), reference_token.end()),
+                                array_index(reference_token)
+                               });
+        }
+    }
+
+    /*!
+    @brief resolve the pointer against a JSON value
+
+    @param[in] j  the JSON value
+    @return pointer to the value referenced within @a j, or `nullptr` if the
+            pointer cannot be resolved
+
+    @complexity Logarithmic in the size of each object along the path;
+    constant for each array.
+    */
+    const BasicJsonType* find(const BasicJsonType& j) const
+    {
+        return resolve(&j);
+    }
+
+    /// @copydoc find(const BasicJsonType&) const
+    BasicJsonType* find(BasicJsonType& j) const
+    {
+        return resolve(&j);
+    }
+
+    /// return whether the pointer can be resolved against @a j
+    bool contains(const BasicJsonType& j) const
+    {
+        return resolve(&j) != nullptr;
+    }
+
+    /// return the number of reference tokens
+    std::size_t size() const noexcept
+    {
+        return m_tokens.size();
+    }
+
+    /// return the JSON pointer this pointer was compiled from
+    const json_pointer<BasicJsonType>& pointer() const noexcept
+    {
+        return m_pointer;
+    }
+
+    /// return a string representation of the JSON pointer
+    std::string to_string() const
+    {
+        return m_pointer.to_string();
+    }
+
+  private:
+    /// a reference token, as an object key and as an array index
+    struct token
+    {
+        /// the token as an object key
+        key_type key;
+        /// the token as an array index, or @ref no_index
+        size_type index;
+    };
+
+    /// the index of tokens that are not valid array indices
+    static constexpr size_type no_index = (std::numeric_limits<size_type>::max)();
+
+    /*!
+    @brief convert a reference token to an array index
+
+    @return the index, or @ref no_index if @a s is not made of digits, has a
+            leading zero, is `-`, or does not fit in `size_type`
+    */
+    static size_type array_index(const std::string& s) noexcept
+    {
+        if (s.empty() or (s.size() > 1 and s[0] == '0'))
+        {
+            return no_index;
+        }
+
+        size_type result = 0;
+        for (const char c : s)
+        {
+            if (c < '0' or c > '9')
+            {
+                return no_index;
+            }
+            const auto digit = static_cast<size_type>(c - '0');
+            if (JSON_UNLIKELY(result > (no_index - 1 - digit) / 10))
+            {
+                return no_index;
+            }
+            result = result * 10 + digit;
+        }
+        return result;
+    }
+
+    /// resolve the tokens, starting with @a ptr
+    template<typename JsonPointer>
+    JsonPointer resolve(JsonPointer ptr) const
+    {
+        for (const auto& t : m_tokens)
+        {
+            switch (ptr->m_type)
+            {
+                case detail::value_t::object:
+                {
+                    const auto it = ptr->m_value.object->find(t.key);
+                    if (it == ptr->m_value.object->end())
+                    {
+                        return nullptr;
+                    }
+                    ptr = &it->second;
+                    break;
+                }
+
+                case detail::value_t::array:
+                {
+                    // no_index is never in range
+                    if (t.index >= ptr->m_value.array->size())
+                    {
+                        return nullptr;
+                    }
+                    ptr = &(*ptr->m_value.array)[t.index];
+                    break;
+                }
+
+                default:
+                    return nullptr;
+            }
+        }
+        return ptr;
+    }
+
+    /// the compiled reference tokens
+    std::vector<token> m_tokens;
+    /// the JSON pointer the tokens were compiled from
+    json_pointer<BasicJsonType> m_pointer;
+};
+
+template<typename BasicJsonType>
+constexpr typename compiled_json_pointer<BasicJsonType>::size_type
+compiled_json_pointer<BasicJsonType>::no_index;
+}
@@ -0,0 +1,584 @@
+#pragma once
+
+#include <cmath> // ldexp
+#include <cstddef> // size_t
+#include <cstdint> // uint8_t, uint16_t, uint32_t, uint64_t, int64_t
+#include <cstring> // memcpy
+#include <limits> // numeric_limits
+
+#include <nlohmann/detail/input/input_adapters.hpp>
+
+namespace nlohmann
+{
+namespace detail
+{
+///////////////////
+// binary cursor //
+///////////////////
+
+/*!
+@brief in-place reader of the data items of a CBOR or MessagePack buffer
+
+Unlike @ref binary_reader, which decodes a whole input into a @ref basic_json
+value, a binary_cursor reads one data item at a time, directly from a buffer,
+and never copies: strings and byte strings refer to the buffer, which must
+outlive their use. Arrays and objects are read as a header only; their
+elements (for objects: key and value, alternately) are the items that follow,
+and whole items can be skipped (see @ref skip).
+
+The cursor does not throw; malformed or truncated input, and features that
+cannot be read in place (CBOR indefinite-length strings), are reported by
+returning `false`.
+*/
+class binary_cursor
+{
+  public:
+    /// the type of a data item
+    enum class item_type : std::uint8_t
+    {
+        null,
+        boolean,
+        number_integer,
+        number_unsigned,
+        number_float,
+        string,
+        binary,
+        array,
+        object
+    };
+
+    /// the size of indefinite-length (CBOR) arrays and objects
+    static constexpr std::size_t indefinite_size = static_cast<std::size_t>(-1);
+
+    /// the maximal nesting depth of skipped items
+    static constexpr int max_depth = 1024;
+
+    /// a data item
+    struct item
+    {
+        /// the type of the item
+        item_type type = item_type::null;
+        /// the value of a boolean item
+        bool boolean = false;
+        /// the value of a number_integer item
+        std::int64_t number_integer = 0;
+        /// the value of a number_unsigned item
+        std::uint64_t number_unsigned = 0;
+        /// the value of a number_float item
+        double number_float = 0.0;
+        /// the bytes of a string or binary item, within the buffer
+        const std::uint8_t* data = nullptr;
+        /// the number of bytes of a string or binary item, the number of
+        /// elements of an array or of members of an object, or
+        /// @ref indefinite_size
+        std::size_t size = 0;
+        /// the CBOR tag or the MessagePack extension type of the item, or -1
+        std::int64_t tag = -1;
+    };
+
+    /*!
+    @param[in] format  the format of the buffer (input_format_t::cbor or
+                       input_format_t::msgpack)
+    @param[in] first   the beginning of the buffer
+    @param[in] last    the end of the buffer
+    */
+    binary_cursor(input_format_t format, const std::uint8_t* first,
+                  const std::uint8_t* last) noexcept
+        : format(format), cursor(first), limit(last)
+    {}
+
+    /*!
+    @brief read the next data item
+
+    @param[out] result  the item
+
+    @return whether an item was read
+    */
+    bool read(item& result) noexcept
+    {
+        result = item();
+        return (format == input_format_t::cbor) ? read_cbor(result) : read_msgpack(result);
+    }
+
+    /*!
+    @brief consume the break that ends an indefinite-length CBOR container
+
+    @return whether the next byte was a break
+    */
+    bool read_break() noexcept
+    {
+        if (format == input_format_t::cbor and cursor != limit and *cursor == 0xFF)
+        {
+            ++cursor;
+            return true;
+        }
+        return false;
+    }
+
+    /*!
+    @brief skip the next data item, including the elements of containers
+
+    @return whether a whole item was skipped
+    */
+    bool skip() noexcept
+    {
+        return skip_internal(0);
+    }
+
+    /// return the position of the next item
+    const std::uint8_t* position() const noexcept
+    {
+        return cursor;
+    }
+
+    /// continue reading at the given position, which must be that of an item
+    void seek(const std::uint8_t* position) noexcept
+    {
+        cursor = position;
+    }
+
+    /// return whether the whole buffer was read
+    bool at_end() const noexcept
+    {
+        return cursor == limit;
+    }
+
+    /// return the format of the buffer
+    input_format_t get_format() const noexcept
+    {
+        return format;
+    }
+
+  private:
+    bool skip_internal(const int depth) noexcept
+    {
+        item value;
+        if (JSON_UNLIKELY(depth > max_depth or not read(value)))
+        {
+            return false;
+        }
+        if (value.type != item_type::array and value.type != item_type::object)
+        {
+            return true;
+        }
+
+        if (value.size == indefinite_size)
+        {
+            while (not read_break())
+            {
+                if (not skip_internal(depth + 1))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // the size was checked against the remaining input, so this does not
+        // overflow
+        const std::size_t count = (value.type == item_type::object) ? 2 * value.size : value.size;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            if (not skip_internal(depth + 1))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /*!
+    @brief read a big-endian unsigned number
+    @return whether the input held sizeof(NumberType) more bytes
+    */
+    template<typename NumberType>
+    bool read_number(NumberType& value) noexcept
+    {
+        if (JSON_UNLIKELY(static_cast<std::size_t>(limit - cursor) < sizeof(NumberType)))
+        {
+            return false;
+        }
+        NumberType result = 0;
+        for (std::size_t i = 0; i < sizeof(NumberType); ++i)
+        {
+            result = static_cast<NumberType>((static_cast<std::uint64_t>(result) << 8) | cursor[i]);
+        }
+        cursor += sizeof(NumberType);
+        value = result;
+        return true;
+    }
+
+    /// read a big-endian number of the given width into a 64-bit number
+    bool read_number(const int width, std::uint64_t& value) noexcept
+    {
+        switch (width)
+        {
+            case 1:
+            {
+                std::uint8_t number = 0;
+                const bool read = read_number(number);
+                value = number;
+                return read;
+            }
+            case 2:
+            {
+                std::uint16_t number = 0;
+                const bool read = read_number(number);
+                value = number;
+                return read;
+            }
+            case 4:
+            {
+                std::uint32_t number = 0;
+                const bool read = read_number(number);
+                value = number;
+                return read;
+            }
+            default:
+                return read_number(value);
+        }
+    }
+
+    bool read_float(item& result) noexcept
+    {
+        std::uint32_t bits;
+        if (not read_number(bits))
+        {
+            return false;
+        }
+        float number;
+        std::memcpy(&number, &bits, sizeof(number));
+        result.type = item_type::number_float;
+        result.number_float = static_cast<double>(number);
+        return true;
+    }
+
+    bool read_double(item& result) noexcept
+    {
+        std::uint64_t bits;
+        if (not read_number(bits))
+        {
+            return false;
+        }
+        result.type = item_type::number_float;
+        std::memcpy(&result.number_float, &bits, sizeof(result.number_float));
+        return true;
+    }
+
+    /// refer to the next @a length bytes as a string or binary item
+    bool read_bytes(const std::uint64_t length, const item_type type, item& result) noexcept
+    {
+        if (JSON_UNLIKELY(length > static_cast<std::uint64_t>(limit - cursor)))
+        {
+            return false;
+        }
+        result.type = type;
+        result.data = cursor;
+        result.size = static_cast<std::size_t>(length);
+        cursor += length;
+        return true;
+    }
+
+    bool read_container(const std::uint64_t size, const item_type type, item& result) noexcept
+    {
+        // every element takes at least one byte, so larger sizes are bogus
+        const auto remaining = static_cast<std::uint64_t>(limit - cursor);
+        if (JSON_UNLIKELY(size > ((type == item_type::object) ? remaining / 2 : remaining)))
+        {
+            return false;
+        }
+        result.type = type;
+        result.size = static_cast<std::size_t>(size);
+        return true;
+    }
+
+    //////////
+    // CBOR //
+    //////////
+
+    /// read the argument of an initial byte (its value, length or count)
+    bool read_cbor_argument(const std::uint8_t initial_byte, std::uint64_t& value) noexcept
+    {
+        const int info = initial_byte & 0x1F;
+        if (info < 24)
+        {
+            value = static_cast<std::uint64_t>(info);
+            return true;
+        }
+        if (JSON_UNLIKELY(info > 27))
+        {
+            return false;
+        }
+        return read_number(1 << (info - 24), value);
+    }
+
+    bool read_cbor(item& result) noexcept
+    {
+        if (JSON_UNLIKELY(cursor == limit))
+        {
+            return false;
+        }
+        std::uint8_t initial_byte = *cursor++;
+
+        // tags (major type 6) precede the item they describe; the innermost
+        // one is kept
+        while ((initial_byte >> 5) == 6)
+        {
+            std::uint64_t tag;
+            if (JSON_UNLIKELY(not read_cbor_argument(initial_byte, tag)
+                              or tag > static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())
+                              or cursor == limit))
+            {
+                return false;
+            }
+            result.tag = static_cast<std::int64_t>(tag);
+            initial_byte = *cursor++;
+        }
+
+        const int major_type = initial_byte >> 5;
+        if (major_type == 7)
+        {
+            switch (initial_byte)
+            {
+                case 0xF4: // false
+                case 0xF5: // true
+                    result.type = item_type::boolean;
+                    result.boolean = (initial_byte == 0xF5);
+                    return true;
+
+                case 0xF6: // null
+                    result.type = item_type::null;
+                    return true;
+
+                case 0xF9: // Half-Precision Float (two-byte IEEE 754)
+                {
+                    std::uint16_t half;
+                    if (not read_number(half))
+                    {
+                        return false;
+                    }
+                    // code from RFC 7049, Appendix D, Figure 3
+                    const int exp = (half >> 10) & 0x1F;
+                    const int mant = half & 0x3FF;
+                    double val;
+                    if (exp == 0)
+                    {
+                        val = std::ldexp(mant, -24);
+                    }
+                    else if (exp != 31)
+                    {
+                        val = std::ldexp(mant + 1024, exp - 25);
+                    }
+                    else
+                    {
+                        val = (mant == 0) ? std::numeric_limits<double>::infinity()
+                              : std::numeric_limits<double>::quiet_NaN();
+                    }
+                    result.type = item_type::number_float;
+                    result.number_float = (half & 0x8000) != 0 ? -val : val;
+                    return true;
+                }
+
+                case 0xFA: // Single-Precision Float (four-byte IEEE 754)
+                    return read_float(result);
+
+                case 0xFB: // Double-Precision Float (eight-byte IEEE 754)
+                    return read_double(result);
+
+                default: // undefined, simple values, or a misplaced break
+                    return false;
+            }
+        }
+
+        if ((initial_byte & 0x1F) == 0x1F)
+        {
+            // indefinite length; strings would have to be concatenated
+            if (major_type == 4 or major_type == 5)
+            {
+                result.type = (major_type == 4) ? item_type::array : item_type::object;
+                result.size = indefinite_size;
+                return true;
+            }
+            return false;
+        }
+
+        std::uint64_t argument;
+        if (JSON_UNLIKELY(not read_cbor_argument(initial_byte, argument)))
+        {
+            return false;
+        }
+
+        switch (major_type)
+        {
+            case 0: // unsigned integer
+                result.type = item_type::number_unsigned;
+                result.number_unsigned = argument;
+                return true;
+
+            case 1: // negative integer -1-n
+                if (JSON_UNLIKELY(argument > static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max())))
+                {
+                    return false;
+                }
+                result.type = item_type::number_integer;
+                result.number_integer = -1 - static_cast<std::int64_t>(argument);
+                return true;
+
+            case 2: // byte string
+                return read_bytes(argument, item_type::binary, result);
+
+            case 3: // UTF-8 string
+                return read_bytes(argument, item_type::string, result);
+
+            case 4: // array
+                return read_container(argument, item_type::array, result);
+
+            default: // map
+                return read_container(argument, item_type::object, result);
+        }
+    }
+
+    /////////////
+    // MsgPack //
+    /////////////
+
+    bool read_msgpack(item& result) noexcept
+    {
+        if (JSON_UNLIKELY(cursor == limit))
+        {
+            return false;
+        }
+        const std::uint8_t byte = *cursor++;
+
+        if (byte <= 0x7F) // positive fixint
+        {
+            result.type = item_type::number_unsigned;
+            result.number_unsigned = byte;
+            return true;
+        }
+        if (byte >= 0xE0) // negative fixint
+        {
+            result.type = item_type::number_integer;
+            result.number_integer = static_cast<std::int8_t>(byte);
+            return true;
+        }
+        if (byte <= 0x8F) // fixmap
+        {
+            return read_container(byte & 0x0F, item_type::object, result);
+        }
+        if (byte <= 0x9F) // fixarray
+        {
+            return read_container(byte & 0x0F, item_type::array, result);
+        }
+        if (byte <= 0xBF) // fixstr
+        {
+            return read_bytes(byte & 0x1F, item_type::string, result);
+        }
+
+        std::uint64_t argument = 0;
+        switch (byte)
+        {
+            case 0xC0: // nil
+                result.type = item_type::null;
+                return true;
+
+            case 0xC2: // false
+            case 0xC3: // true
+                result.type = item_type::boolean;
+                result.boolean = (byte == 0xC3);
+                return true;
+
+            case 0xC4: // bin 8
+            case 0xC5: // bin 16
+            case 0xC6: // bin 32
+                return read_number(1 << (byte - 0xC4), argument)
+                       and read_bytes(argument, item_type::binary, result);
+
+            case 0xC7: // ext 8
+            case 0xC8: // ext 16
+            case 0xC9: // ext 32
+            {
+                std::uint8_t type;
+                if (not read_number(1 << (byte - 0xC7), argument) or not read_number(type))
+                {
+                    return false;
+                }
+                result.tag = static_cast<std::int8_t>(type);
+                return read_bytes(argument, item_type::binary, result);
+            }
+
+            case 0xCA: // float 32
+                return read_float(result);
+
+            case 0xCB: // float 64
+                return read_double(result);
+
+            case 0xCC: // uint 8
+            case 0xCD: // uint 16
+            case 0xCE: // uint 32
+            case 0xCF: // uint 64
+                result.type = item_type::number_unsigned;
+                return read_number(1 << (byte - 0xCC), result.number_unsigned);
+
+            case 0xD0: // int 8
+            case 0xD1: // int 16
+            case 0xD2: // int 32
+            case 0xD3: // int 64
+            {
+                const int width = 1 << (byte - 0xD0);
+                if (not read_number(width, argument))
+                {
+                    return false;
+                }
+                // sign-extend
+                const int shift = 64 - 8 * width;
+                result.type = item_type::number_integer;
+                result.number_integer = static_cast<std::int64_t>(argument << shift) >> shift;
+                return true;
+            }
+
+            case 0xD4: // fixext 1
+            case 0xD5: // fixext 2
+            case 0xD6: // fixext 4
+            case 0xD7: // fixext 8
+            case 0xD8: // fixext 16
+            {
+                std::uint8_t type;
+                if (not read_number(type))
+                {
+                    return false;
+                }
+                result.tag = static_cast<std::int8_t>(type);
+                return read_bytes(1u << (byte - 0xD4), item_type::binary, result);
+            }
+
+            case 0xD9: // str 8
+            case 0xDA: // str 16
+            case 0xDB: // str 32
+                return read_number(1 << (byte - 0xD9), argument)
+                       and read_bytes(argument, item_type::string, result);
+
+            case 0xDC: // array 16
+            case 0xDD: // array 32
+                return read_number(2 << (byte - 0xDC), argument)
+                       and read_container(argument, item_type::array, result);
+
+            case 0xDE: // map 16
+            case 0xDF: // map 32
+                return read_number(2 << (byte - 0xDE), argument)
+                       and read_container(argument, item_type::object, result);
+
+            default: // 0xC1 is never used
+                return false;
+        }
+    }
+
+    /// the format of the buffer
+    const input_format_t format;
+    /// the next byte to read
+    const std::uint8_t* cursor;
+    /// the end of the buffer
+    const std::uint8_t* const limit;
+};
+}
+}
@@ -18,6 +18,7 @@
 #include <nlohmann/detail/input/input_adapters.hpp>
 #include <nlohmann/detail/exceptions.hpp>
 #include <nlohmann/detail/macro_scope.hpp>
+#include <nlohmann/detail/typed_array.hpp>
 #include <nlohmann/detail/value_t.hpp>
 
 namespace nlohmann
@@ -378,6 +379,18 @@ class binary_reader
                 return result;
             }
 
+            case 0xD8: // tag (one-byte tag follows)
+            {
+                const auto tag = get_number<uint8_t>();
+                typed_array_type type;
+                if (JSON_UNLIKELY(not get_cbor_typed_array_type(tag, type)))
+                {
+                    JSON_THROW(parse_error::create(112, chars_read,
+                                                   "unsupported CBOR tag: " + std::to_string(tag)));
+                }
+                return get_cbor_typed_array(type);
+            }
+
             case 0xF4: // false
             {
                 return false;
@@ -672,6 +685,18 @@ class binary_reader
             case 0xC3: // true
                 return true;
 
+            case 0xC7: // ext 8
+                return get_msgpack_typed_array(get_number<uint8_t>());
+
+            case 0xC8: // ext 16
+                return get_msgpack_typed_array(get_number<uint16_t>());
+
+            case 0xC9: // ext 32
+                return get_msgpack_typed_array(get_number<uint32_t>());
+
+            case 0xD7: // fixext 8
+                return get_msgpack_typed_array(static_cast<std::size_t>(8));
+
             case 0xCA: // float 32
                 return get_number<float>();
 
@@ -989,6 +1014,141 @@ class binary_reader
         return result;
     }
 
+    /*!
+    @brief reads the byte string of a CBOR typed array (RFC 8746)
+
+    @param[in] type  the element layout, given by the tag
+
+    @return JSON array of the elements
+
+    @throw parse_error.110 if input ended
+    @throw parse_error.113 if no definite-length byte string is read
+    */
+    BasicJsonType get_cbor_typed_array(const typed_array_type& type)
+    {
+        switch (get())
+        {
+            // Byte string (0x00..0x17 bytes follow)
+            case 0x40:
+            case 0x41:
+            case 0x42:
+            case 0x43:
+            case 0x44:
+            case 0x45:
+            case 0x46:
+            case 0x47:
+            case 0x48:
+            case 0x49:
+            case 0x4A:
+            case 0x4B:
+            case 0x4C:
+            case 0x4D:
+            case 0x4E:
+            case 0x4F:
+            case 0x50:
+            case 0x51:
+            case 0x52:
+            case 0x53:
+            case 0x54:
+            case 0x55:
+            case 0x56:
+            case 0x57:
+                return get_typed_array(type, static_cast<std::size_t>(current & 0x1F));
+
+            case 0x58: // Byte string (one-byte uint8_t for n follows)
+                return get_typed_array(type, get_number<uint8_t>());
+
+            case 0x59: // Byte string (two-byte uint16_t for n follow)
+                return get_typed_array(type, get_number<uint16_t>());
+
+            case 0x5A: // Byte string (four-byte uint32_t for n follow)
+                return get_typed_array(type, get_number<uint32_t>());
+
+            case 0x5B: // Byte string (eight-byte uint64_t for n follow)
+                return get_typed_array(type, get_number<uint64_t>());
+
+            default:
+            {
+                unexpect_eof();
+                std::stringstream ss;
+                ss << std::setw(2) << std::uppercase << std::setfill('0') << std::hex << current;
+                JSON_THROW(parse_error::create(113, chars_read, "expected a byte string after a CBOR typed array tag; last byte: 0x" + ss.str()));
+            }
+        }
+    }
+
+    /*!
+    @brief reads a MessagePack extension, which must be a typed array (see
+           @ref msgpack_float64_array_type)
+
+    @param[in] len  the length of the extension payload
+
+    @return JSON array of the elements
+
+    @throw parse_error.110 if input ended
+    @throw parse_error.112 if the extension type is not supported
+    */
+    template<typename NumberType>
+    BasicJsonType get_msgpack_typed_array(const NumberType len)
+    {
+        const auto type = get_number<int8_t>();
+        if (JSON_UNLIKELY(type != msgpack_float64_array_type))
+        {
+            JSON_THROW(parse_error::create(112, chars_read,
+                                           "unsupported MessagePack extension type: " + std::to_string(type)));
+        }
+        return get_typed_array(msgpack_float64_array_layout(), len);
+    }
+
+    /*!
+    @brief reads the elements of a typed array
+
+    @param[in] type  the element layout
+    @param[in] len   the number of bytes of the elements
+
+    @return JSON array of the elements
+
+    @throw parse_error.110 if input ended
+    @throw parse_error.113 if @a len is not a multiple of the element size
+    */
+    template<typename NumberType>
+    BasicJsonType get_typed_array(const typed_array_type& type, const NumberType len)
+    {
+        if (JSON_UNLIKELY(len % type.element_size != 0))
+        {
+            JSON_THROW(parse_error::create(113, chars_read, "typed array length " + std::to_string(len) +
+                                           " is not a multiple of its element size"));
+        }
+
+        BasicJsonType result = value_t::array;
+        std::array<uint8_t, sizeof(uint64_t)> element;
+        for (NumberType i = 0; i < len / type.element_size; ++i)
+        {
+            for (std::size_t j = 0; j < type.element_size; ++j)
+            {
+                get();
+                unexpect_eof();
+                element[j] = static_cast<uint8_t>(current);
+            }
+
+            if (type.is_float)
+            {
+                result.m_value.array->emplace_back(get_typed_array_element(type, element.data()));
+            }
+            else if (type.is_signed)
+            {
+                result.m_value.array->emplace_back(
+                    static_cast<number_integer_t>(static_cast<int64_t>(get_typed_array_bits(type, element.data()))));
+            }
+            else
+            {
+                result.m_value.array->emplace_back(
+                    static_cast<number_unsigned_t>(get_typed_array_bits(type, element.data())));
+            }
+        }
+        return result;
+    }
+
     /*!
     @brief reads a MessagePack string
 
@@ -20,6 +20,9 @@ namespace nlohmann
 {
 namespace detail
 {
+/// the supported input formats
+enum class input_format_t { json, cbor, msgpack, ubjson };
+
 ////////////////////
 // input adapters //
 ////////////////////
@@ -41,6 +44,23 @@ struct input_adapter_protocol
     virtual std::char_traits<char>::int_type get_character() = 0;
     /// restore the last non-eof() character to input
     virtual void unget_character() = 0;
+    /*!
+    @brief get the remaining input as a contiguous character range
+
+    Adapters reading from memory return the range, which the lexer then reads
+    directly, without calling get_character/unget_character (and therefore
+    without advancing the adapter). Other adapters return false.
+
+    @param[out] first  the first remaining character
+    @param[out] last   the end of the input
+    @return whether the remaining input is contiguous in memory
+    */
+    virtual bool get_contiguous_range(const char*& first, const char*& last)
+    {
+        static_cast<void>(first);
+        static_cast<void>(last);
+        return false;
+    }
     virtual ~input_adapter_protocol() = default;
 };
 
@@ -156,6 +176,13 @@ class input_buffer_adapter : public input_adapter_protocol
         }
     }
 
+    bool get_contiguous_range(const char*& first, const char*& last) noexcept override
+    {
+        first = cursor;
+        last = limit;
+        return true;
+    }
+
   private:
     /// pointer to the current character
     const char* cursor;
@@ -1,16 +1,21 @@
 #pragma once
 
-#include <clocale> // localeconv
 #include <cstddef> // size_t
-#include <cstdlib> // strtof, strtod, strtold, strtoll, strtoull
+#include <cstdint> // uint64_t, int64_t
 #include <initializer_list> // initializer_list
 #include <ios> // hex, uppercase
 #include <iomanip> // setw, setfill
+#include <limits> // numeric_limits
 #include <sstream> // stringstream
 #include <string> // char_traits, string
 #include <vector> // vector
 
+#if defined(__SSE2__)
+    #include <emmintrin.h> // _mm_loadu_si128, _mm_cmpeq_epi8, _mm_movemask_epi8
+#endif
+
 #include <nlohmann/detail/macro_scope.hpp>
+#include <nlohmann/detail/conversions/from_chars.hpp>
 #include <nlohmann/detail/input/input_adapters.hpp>
 
 namespace nlohmann
@@ -100,25 +105,16 @@ class lexer
     }
 
     explicit lexer(detail::input_adapter_t adapter)
-        : ia(std::move(adapter)), decimal_point_char(get_decimal_point()) {}
+        : ia(std::move(adapter))
+    {
+        init_contiguous_range();
+    }
 
     // delete because of pointer members
     lexer(const lexer&) = delete;
     lexer& operator=(lexer&) = delete;
 
   private:
-    /////////////////////
-    // locales
-    /////////////////////
-
-    /// return the locale-dependent decimal point
-    static char get_decimal_point() noexcept
-    {
-        const auto loc = localeconv();
-        assert(loc != nullptr);
-        return (loc->decimal_point == nullptr) ? '.' : *(loc->decimal_point);
-    }
-
     /////////////////////
     // scan functions
     /////////////////////
@@ -233,6 +229,12 @@ class lexer
 
         while (true)
         {
+            // copy characters that need no further processing in bulk
+            if (buffer_cursor != nullptr)
+            {
+                scan_string_run();
+            }
+
             // get next character
             switch (get())
             {
@@ -654,19 +656,23 @@ class lexer
         }
     }
 
-    static void strtof(float& f, const char* str, char** endptr) noexcept
-    {
-        f = std::strtof(str, endptr);
-    }
-
-    static void strtof(double& f, const char* str, char** endptr) noexcept
-    {
-        f = std::strtod(str, endptr);
-    }
-
-    static void strtof(long double& f, const char* str, char** endptr) noexcept
+    /*!
+    @brief converts the digits in [first, last) to an unsigned integer
+    @return whether the number fits in 64 bits
+    */
+    static bool to_unsigned(const char* first, const char* last, uint64_t& value) noexcept
     {
-        f = std::strtold(str, endptr);
+        value = 0;
+        for (; first != last; ++first)
+        {
+            const auto digit = static_cast<uint64_t>(*first - '0');
+            if (JSON_UNLIKELY(value > (std::numeric_limits<uint64_t>::max() - digit) / 10))
+            {
+                return false;
+            }
+            value = value * 10 + digit;
+        }
+        return true;
     }
 
     /*!
@@ -705,9 +711,8 @@ class lexer
             token_type::value_float if number could be successfully scanned,
             token_type::parse_error otherwise
 
-    @note The scanner is independent of the current locale. Internally, the
-          locale's decimal point is used instead of `.` to work with the
-          locale-dependent converters.
+    @note The scanner and the conversions are independent of the current
+          locale (see @ref from_chars).
     */
     token_type scan_number()
     {
@@ -792,7 +797,7 @@ scan_number_zero:
         {
             case '.':
             {
-                add(decimal_point_char);
+                add('.');
                 goto scan_number_decimal1;
             }
 
@@ -828,7 +833,7 @@ scan_number_any1:
 
             case '.':
             {
-                add(decimal_point_char);
+                add('.');
                 goto scan_number_decimal1;
             }
 
@@ -989,18 +994,16 @@ scan_number_done:
         // we are done scanning a number)
         unget();
 
-        char* endptr = nullptr;
-        errno = 0;
+        // we checked the number format before, so the conversions below only
+        // fail if an integer is out of range
+        const char* const first = token_buffer.data();
+        const char* const last = first + token_buffer.size();
 
         // try to parse integers first and fall back to floats
+        uint64_t x = 0;
         if (number_type == token_type::value_unsigned)
         {
-            const auto x = std::strtoull(token_buffer.data(), &endptr, 10);
-
-            // we checked the number format before
-            assert(endptr == token_buffer.data() + token_buffer.size());
-
-            if (errno == 0)
+            if (to_unsigned(first, last, x))
             {
                 value_unsigned = static_cast<number_unsigned_t>(x);
                 if (value_unsigned == x)
@@ -1011,15 +1014,15 @@ scan_number_done:
         }
         else if (number_type == token_type::value_integer)
         {
-            const auto x = std::strtoll(token_buffer.data(), &endptr, 10);
-
-            // we checked the number format before
-            assert(endptr == token_buffer.data() + token_buffer.size());
-
-            if (errno == 0)
+            // skip the minus sign
+            if (to_unsigned(first + 1, last, x)
+                    and x <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + 1)
             {
-                value_integer = static_cast<number_integer_t>(x);
-                if (value_integer == x)
+                const int64_t y = (x == static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + 1)
+                                  ? std::numeric_limits<int64_t>::min()
+                                  : -static_cast<int64_t>(x);
+                value_integer = static_cast<number_integer_t>(y);
+                if (value_integer == y)
                 {
                     return token_type::value_integer;
                 }
@@ -1028,10 +1031,7 @@ scan_number_done:
 
         // this code is reached if we parse a floating-point number or if an
         // integer conversion above failed
-        strtof(value_float, token_buffer.data(), &endptr);
-
-        // we checked the number format before
-        assert(endptr == token_buffer.data() + token_buffer.size());
+        from_chars(first, last, value_float);
 
         return token_type::value_float;
     }
@@ -1060,10 +1060,111 @@ scan_number_done:
     // input management
     /////////////////////
 
+    /// read the input directly if it is contiguous in memory
+    void init_contiguous_range()
+    {
+        buffer_cursor = buffer_limit = token_start = nullptr;
+        const char* first = nullptr;
+        const char* last = nullptr;
+        if (ia != nullptr and ia->get_contiguous_range(first, last))
+        {
+            buffer_cursor = token_start = first;
+            buffer_limit = last;
+        }
+    }
+
+    /*!
+    @brief find the first character in [first, last) that is not whitespace,
+           or that needs processing within a string (quote, backslash, control
+           or non-ASCII character)
+
+    @param[in] first   the first character to examine
+    @param[in] last    the end of the range
+    @param[in] string  whether to look for string characters rather than
+                       whitespace
+    @return the first such character, or last
+    */
+    static const char* find_special(const char* first, const char* last, const bool string) noexcept
+    {
+#if defined(__SSE2__)
+        const __m128i quote = _mm_set1_epi8('\"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i control = _mm_set1_epi8(0x20);
+        const __m128i space = _mm_set1_epi8(' ');
+        const __m128i tab = _mm_set1_epi8('\t');
+        const __m128i newline = _mm_set1_epi8('\n');
+        const __m128i carriage_return = _mm_set1_epi8('\r');
+        while (last - first >= 16)
+        {
+            const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+            int mask;
+            if (string)
+            {
+                // a signed comparison catches both control (< 0x20) and
+                // non-ASCII (>= 0x80) characters
+                mask = _mm_movemask_epi8(_mm_or_si128(
+                                             _mm_or_si128(_mm_cmpeq_epi8(chars, quote), _mm_cmpeq_epi8(chars, backslash)),
+                                             _mm_cmplt_epi8(chars, control)));
+            }
+            else
+            {
+                mask = _mm_movemask_epi8(_mm_or_si128(
+                                             _mm_or_si128(_mm_cmpeq_epi8(chars, space), _mm_cmpeq_epi8(chars, tab)),
+                                             _mm_or_si128(_mm_cmpeq_epi8(chars, newline), _mm_cmpeq_epi8(chars, carriage_return))));
+                mask ^= 0xFFFF;
+            }
+            if (mask != 0)
+            {
+                return first + __builtin_ctz(static_cast<unsigned int>(mask));
+            }
+            first += 16;
+        }
+#endif
+        for (; first != last; ++first)
+        {
+            const auto c = static_cast<unsigned char>(*first);
+            const bool special = string
+                                 ? (c == '\"' or c == '\\' or c < 0x20 or c >= 0x80)
+                                 : not (c == ' ' or c == '\t' or c == '\n' or c == '\r');
+            if (special)
+            {
+                break;
+            }
+        }
+        return first;
+    }
+
+    /// skip whitespace within a contiguous input; the next get() returns the
+    /// first character after it
+    void skip_whitespace_run() noexcept
+    {
+        const char* end = find_special(buffer_cursor, buffer_limit, false);
+        chars_read += static_cast<std::size_t>(end - buffer_cursor);
+        buffer_cursor = end;
+    }
+
+    /// copy string characters that need no processing (no quote, backslash,
+    /// control or non-ASCII character) from a contiguous input in bulk
+    void scan_string_run()
+    {
+        const char* end = find_special(buffer_cursor, buffer_limit, true);
+        if (end != buffer_cursor)
+        {
+            token_buffer.append(buffer_cursor, static_cast<std::size_t>(end - buffer_cursor));
+            chars_read += static_cast<std::size_t>(end - buffer_cursor);
+            buffer_cursor = end;
+        }
+    }
+
     /// reset token_buffer; current character is beginning of token
     void reset() noexcept
     {
         token_buffer.clear();
+        if (buffer_cursor != nullptr)
+        {
+            token_start = (current != std::char_traits<char>::eof()) ? buffer_cursor - 1 : buffer_cursor;
+            return;
+        }
         token_string.clear();
         token_string.push_back(std::char_traits<char>::to_char_type(current));
     }
@@ -1081,6 +1182,17 @@ scan_number_done:
     std::char_traits<char>::int_type get()
     {
         ++chars_read;
+
+        // contiguous input: read it directly; the token string is the range
+        // starting at token_start
+        if (buffer_cursor != nullptr)
+        {
+            current = JSON_LIKELY(buffer_cursor < buffer_limit)
+                      ? std::char_traits<char>::to_int_type(*(buffer_cursor++))
+                      : std::char_traits<char>::eof();
+            return current;
+        }
+
         current = ia->get_character();
         if (JSON_LIKELY(current != std::char_traits<char>::eof()))
         {
@@ -1095,6 +1207,11 @@ scan_number_done:
         --chars_read;
         if (JSON_LIKELY(current != std::char_traits<char>::eof()))
         {
+            if (buffer_cursor != nullptr)
+            {
+                --buffer_cursor;
+                return;
+            }
             ia->unget_character();
             assert(token_string.size() != 0);
             token_string.pop_back();
@@ -1136,6 +1253,32 @@ scan_number_done:
         return std::move(token_buffer);
     }
 
+    /// return current string value (valid until the next token is read)
+    string_t& get_string()
+    {
+        return token_buffer;
+    }
+
+    /*!
+    @brief read from another input
+
+    Rewinds the lexer to the beginning of the given input. The token buffers
+    keep their capacity, so that a lexer which is reused for many small
+    inputs does not allocate once its buffers are large enough.
+
+    @param[in] adapter  the input to read from
+    */
+    void reset_input(detail::input_adapter_t adapter)
+    {
+        ia = std::move(adapter);
+        current = std::char_traits<char>::eof();
+        chars_read = 0;
+        token_string.clear();
+        token_buffer.clear();
+        error_message = "";
+        init_contiguous_range();
+    }
+
     /////////////////////
     // diagnostics
     /////////////////////
@@ -1151,9 +1294,15 @@ scan_number_done:
     /// 255 may legitimately occur.  May contain NUL, which should be escaped.
     std::string get_token_string() const
     {
+        // contiguous input: the token string is the range read since the
+        // beginning of the token
+        const std::vector<char> contiguous_token_string =
+            (buffer_cursor != nullptr) ? std::vector<char>(token_start, buffer_cursor) : std::vector<char>();
+        const std::vector<char>& chars = (buffer_cursor != nullptr) ? contiguous_token_string : token_string;
+
         // escape control characters
         std::string result;
-        for (const auto c : token_string)
+        for (const auto c : chars)
         {
             if ('\x00' <= c and c <= '\x1F')
             {
@@ -1185,6 +1334,12 @@ scan_number_done:
 
     token_type scan()
     {
+        // skip whitespace in bulk
+        if (buffer_cursor != nullptr)
+        {
+            skip_whitespace_run();
+        }
+
         // read next character and ignore whitespace
         do
         {
@@ -1260,6 +1415,13 @@ scan_number_done:
     /// raw input token string (for error messages)
     std::vector<char> token_string {};
 
+    /// the next character of a contiguous input (null for other inputs)
+    const char* buffer_cursor = nullptr;
+    /// the end of a contiguous input
+    const char* buffer_limit = nullptr;
+    /// the beginning of the raw token string within a contiguous input
+    const char* token_start = nullptr;
+
     /// buffer for variable-length tokens (numbers, strings)
     string_t token_buffer {};
 
@@ -1270,9 +1432,6 @@ scan_number_done:
     number_integer_t value_integer = 0;
     number_unsigned_t value_unsigned = 0;
     number_float_t value_float = 0;
-
-    /// the decimal point
-    const char decimal_point_char = '.';
 };
 }
 }
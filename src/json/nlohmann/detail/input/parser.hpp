@@ -10,6 +10,7 @@
 #include <nlohmann/detail/exceptions.hpp>
 #include <nlohmann/detail/macro_scope.hpp>
 #include <nlohmann/detail/input/input_adapters.hpp>
+#include <nlohmann/detail/input/json_sax.hpp>
 #include <nlohmann/detail/input/lexer.hpp>
 #include <nlohmann/detail/value_t.hpp>
 
@@ -123,7 +124,223 @@ class parser
         return not strict or (get_token() == token_type::end_of_input);
     }
 
+    /*!
+    @brief public SAX interface
+
+    Reports the input as a sequence of events to the given SAX handler,
+    without building a DOM. No exceptions are thrown: parse errors are
+    reported through the parse_error event instead.
+
+    @param[in] sax     the SAX handler, which has the member functions of
+                       @ref json_sax (it may, but need not, derive from it)
+    @param[in] strict  whether to expect the last token to be EOF
+    @return whether the input was read completely, i.e. there was no parse
+            error and no event handler returned false
+    */
+    template<typename SAX>
+    bool sax_parse(SAX* sax, const bool strict = true)
+    {
+        // read first token
+        get_token();
+
+        if (not sax_parse_internal(sax))
+        {
+            return false;
+        }
+
+        // strict => last token must be EOF
+        if (strict and get_token() != token_type::end_of_input)
+        {
+            return sax_parse_error(sax, token_type::end_of_input);
+        }
+        return true;
+    }
+
+    /*!
+    @brief read from another input
+
+    Rewinds the parser to the beginning of the given input, so that it can be
+    reused without allocating new token buffers.
+
+    @param[in] adapter  the input to read from
+    */
+    void reset_input(detail::input_adapter_t adapter)
+    {
+        depth = 0;
+        last_token = token_type::uninitialized;
+        errored = false;
+        expected = token_type::uninitialized;
+        m_lexer.reset_input(std::move(adapter));
+    }
+
   private:
+    /*!
+    @brief the actual SAX parser
+
+    @invariant The last token is not yet processed; when this function
+               returns, the last token is processed.
+    */
+    template<typename SAX>
+    bool sax_parse_internal(SAX* sax)
+    {
+        switch (last_token)
+        {
+            case token_type::begin_object:
+            {
+                if (JSON_UNLIKELY(not sax->start_object(std::size_t(-1))))
+                {
+                    return false;
+                }
+
+                // read next token
+                get_token();
+
+                // closing } -> we are done
+                if (last_token == token_type::end_object)
+                {
+                    return sax->end_object();
+                }
+
+                // parse values
+                while (true)
+                {
+                    // parse key
+                    if (JSON_UNLIKELY(last_token != token_type::value_string))
+                    {
+                        return sax_parse_error(sax, token_type::value_string);
+                    }
+                    if (JSON_UNLIKELY(not sax->key(m_lexer.get_string())))
+                    {
+                        return false;
+                    }
+
+                    // parse separator (:)
+                    get_token();
+                    if (JSON_UNLIKELY(last_token != token_type::name_separator))
+                    {
+                        return sax_parse_error(sax, token_type::name_separator);
+                    }
+
+                    // parse value
+                    get_token();
+                    if (not sax_parse_internal(sax))
+                    {
+                        return false;
+                    }
+
+                    // comma -> next value
+                    get_token();
+                    if (last_token == token_type::value_separator)
+                    {
+                        get_token();
+                        continue;
+                    }
+
+                    // closing }
+                    if (JSON_UNLIKELY(last_token != token_type::end_object))
+                    {
+                        return sax_parse_error(sax, token_type::end_object);
+                    }
+                    return sax->end_object();
+                }
+            }
+
+            case token_type::begin_array:
+            {
+                if (JSON_UNLIKELY(not sax->start_array(std::size_t(-1))))
+                {
+                    return false;
+                }
+
+                // read next token
+                get_token();
+
+                // closing ] -> we are done
+                if (last_token == token_type::end_array)
+                {
+                    return sax->end_array();
+                }
+
+                // parse values
+                while (true)
+                {
+                    // parse value
+                    if (not sax_parse_internal(sax))
+                    {
+                        return false;
+                    }
+
+                    // comma -> next value
+                    get_token();
+                    if (last_token == token_type::value_separator)
+                    {
+                        get_token();
+                        continue;
+                    }
+
+                    // closing ]
+                    if (JSON_UNLIKELY(last_token != token_type::end_array))
+                    {
+                        return sax_parse_error(sax, token_type::end_array);
+                    }
+                    return sax->end_array();
+                }
+            }
+
+            case token_type::value_float:
+            {
+                const auto res = m_lexer.get_number_float();
+
+                // report infinity or NAN as an error
+                if (JSON_UNLIKELY(not std::isfinite(res)))
+                {
+                    errored = true;
+                    return sax->parse_error(m_lexer.get_position(),
+                                            m_lexer.get_token_string(),
+                                            out_of_range::create(406, "number overflow parsing '" +
+                                                    m_lexer.get_token_string() + "'"));
+                }
+                return sax->number_float(res, m_lexer.get_string());
+            }
+
+            case token_type::literal_false:
+                return sax->boolean(false);
+
+            case token_type::literal_null:
+                return sax->null();
+
+            case token_type::literal_true:
+                return sax->boolean(true);
+
+            case token_type::value_integer:
+                return sax->number_integer(m_lexer.get_number_integer());
+
+            case token_type::value_string:
+                return sax->string(m_lexer.get_string());
+
+            case token_type::value_unsigned:
+                return sax->number_unsigned(m_lexer.get_number_unsigned());
+
+            case token_type::parse_error:
+                // using "uninitialized" to avoid "expected" message
+                return sax_parse_error(sax, token_type::uninitialized);
+
+            default: // the last token was unexpected
+                return sax_parse_error(sax, token_type::literal_or_value);
+        }
+    }
+
+    /// report a syntax error to the given SAX handler; always returns false
+    template<typename SAX>
+    bool sax_parse_error(SAX* sax, token_type t)
+    {
+        errored = true;
+        expected = t;
+        sax->parse_error(m_lexer.get_position(), m_lexer.get_token_string(),
+                         parse_error::create(101, m_lexer.get_position(), exception_message()));
+        return false;
+    }
+
     /*!
     @brief the actual parser
     @throw parse_error.101 in case of an unexpected token
@@ -551,6 +768,12 @@ class parser
     }
 
     [[noreturn]] void throw_exception() const
+    {
+        JSON_THROW(parse_error::create(101, m_lexer.get_position(), exception_message()));
+    }
+
+    /// describe the syntax error at the last token
+    std::string exception_message() const
     {
         std::string error_msg = "syntax error - ";
         if (last_token == token_type::parse_error)
@@ -568,7 +791,7 @@ class parser
             error_msg += "; expected " + std::string(lexer_t::token_type_name(expected));
         }
 
-        JSON_THROW(parse_error::create(101, m_lexer.get_position(), error_msg));
+        return error_msg;
     }
 
   private:
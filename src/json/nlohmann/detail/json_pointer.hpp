@@ -3,6 +3,7 @@
 #include <cassert> // assert
 #include <numeric> // accumulate
 #include <string> // string
+#include <type_traits> // enable_if, is_same
 #include <vector> // vector
 
 #include <nlohmann/detail/macro_scope.hpp>
@@ -17,6 +18,8 @@ class json_pointer
     // allow basic_json to access private members
     NLOHMANN_BASIC_JSON_TPL_DECLARATION
     friend class basic_json;
+    // allow compiled pointers to read the reference tokens
+    template<typename> friend class compiled_json_pointer;
 
   public:
     /*!
@@ -97,6 +100,26 @@ class json_pointer
     }
 
   private:
+    /*!
+    @brief convert a reference token to an object key
+
+    Returns the token itself if objects use `std::string` keys, and a copy in
+    the key type otherwise (e.g., a string with another allocator).
+    */
+    template<typename KeyType = typename BasicJsonType::object_t::key_type>
+    static typename std::enable_if<std::is_same<KeyType, std::string>::value, const std::string&>::type
+    to_key(const std::string& reference_token)
+    {
+        return reference_token;
+    }
+
+    template<typename KeyType = typename BasicJsonType::object_t::key_type>
+    static typename std::enable_if<not std::is_same<KeyType, std::string>::value, KeyType>::type
+    to_key(const std::string& reference_token)
+    {
+        return KeyType(reference_token.begin(), reference_token.end());
+    }
+
     /*!
     @brief remove and return last reference pointer
     @throw out_of_range.405 if JSON pointer has no parent
@@ -160,7 +183,7 @@ class json_pointer
                     else
                     {
                         // start a new object otherwise
-                        result = &result->operator[](reference_token);
+                        result = &result->operator[](to_key(reference_token));
                     }
                     break;
                 }
@@ -168,7 +191,7 @@ class json_pointer
                 case detail::value_t::object:
                 {
                     // create an entry in the object
-                    result = &result->operator[](reference_token);
+                    result = &result->operator[](to_key(reference_token));
                     break;
                 }
 
@@ -246,7 +269,7 @@ class json_pointer
                 case detail::value_t::object:
                 {
                     // use unchecked object access
-                    ptr = &ptr->operator[](reference_token);
+                    ptr = &ptr->operator[](to_key(reference_token));
                     break;
                 }
 
@@ -305,7 +328,7 @@ class json_pointer
                 case detail::value_t::object:
                 {
                     // note: at performs range check
-                    ptr = &ptr->at(reference_token);
+                    ptr = &ptr->at(to_key(reference_token));
                     break;
                 }
 
@@ -370,7 +393,7 @@ class json_pointer
                 case detail::value_t::object:
                 {
                     // use unchecked object access
-                    ptr = &ptr->operator[](reference_token);
+                    ptr = &ptr->operator[](to_key(reference_token));
                     break;
                 }
 
@@ -429,7 +452,7 @@ class json_pointer
                 case detail::value_t::object:
                 {
                     // note: at performs range check
-                    ptr = &ptr->at(reference_token);
+                    ptr = &ptr->at(to_key(reference_token));
                     break;
                 }
 
@@ -599,7 +622,7 @@ class json_pointer
                 if (value.m_value.array->empty())
                 {
                     // flatten empty array as null
-                    result[reference_string] = nullptr;
+                    result[to_key(reference_string)] = nullptr;
                 }
                 else
                 {
@@ -618,14 +641,15 @@ class json_pointer
                 if (value.m_value.object->empty())
                 {
                     // flatten empty object as null
-                    result[reference_string] = nullptr;
+                    result[to_key(reference_string)] = nullptr;
                 }
                 else
                 {
                     // iterate object and use keys as reference string
                     for (const auto& element : *value.m_value.object)
                     {
-                        flatten(reference_string + "/" + escape(element.first), element.second, result);
+                        flatten(reference_string + "/" + escape(std::string(element.first.begin(), element.first.end())),
+                                element.second, result);
                     }
                 }
                 break;
@@ -634,7 +658,7 @@ class json_pointer
             default:
             {
                 // add primitive value with its reference string
-                result[reference_string] = value;
+                result[to_key(reference_string)] = value;
                 break;
             }
         }
@@ -672,7 +696,7 @@ class json_pointer
             // the JSON pointer is "" (i.e., points to the whole value), function
             // get_and_create returns a reference to result itself. An assignment
             // will then create a primitive value.
-            json_pointer(element.first).get_and_create(result) = element.second;
+            json_pointer(std::string(element.first.begin(), element.first.end())).get_and_create(result) = element.second;
         }
 
         return result;
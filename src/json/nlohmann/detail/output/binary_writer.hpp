@@ -2,12 +2,14 @@
 
 #include <algorithm> // reverse
 #include <array> // array
+#include <cstddef> // ptrdiff_t, size_t
 #include <cstdint> // uint8_t, uint16_t, uint32_t, uint64_t
 #include <cstring> // memcpy
 #include <limits> // numeric_limits
 
 #include <nlohmann/detail/input/binary_reader.hpp>
 #include <nlohmann/detail/output/output_adapters.hpp>
+#include <nlohmann/detail/typed_array.hpp>
 
 namespace nlohmann
 {
@@ -676,6 +678,106 @@ class binary_writer
         }
     }
 
+    /*!
+    @brief write an array of doubles as a CBOR typed array (RFC 8746)
+
+    The array is a byte string tagged as an array of doubles in host byte
+    order, so the values are written with a single copy.
+
+    @param[in] values  the values
+    @param[in] count   the number of values
+    */
+    void write_cbor_typed_array(const double* values, const std::size_t count)
+    {
+        // step 1: write the tag (1 byte follows)
+        oa->write_character(static_cast<CharType>(0xD8));
+        oa->write_character(static_cast<CharType>(cbor_float64_array_tag()));
+
+        // step 2: write control byte and the byte string length
+        const auto N = count * sizeof(double);
+        if (N <= 0x17)
+        {
+            write_number(static_cast<uint8_t>(0x40 + N));
+        }
+        else if (N <= (std::numeric_limits<uint8_t>::max)())
+        {
+            oa->write_character(static_cast<CharType>(0x58));
+            write_number(static_cast<uint8_t>(N));
+        }
+        else if (N <= (std::numeric_limits<uint16_t>::max)())
+        {
+            oa->write_character(static_cast<CharType>(0x59));
+            write_number(static_cast<uint16_t>(N));
+        }
+        else if (N <= (std::numeric_limits<uint32_t>::max)())
+        {
+            oa->write_character(static_cast<CharType>(0x5A));
+            write_number(static_cast<uint32_t>(N));
+        }
+        // LCOV_EXCL_START
+        else
+        {
+            oa->write_character(static_cast<CharType>(0x5B));
+            write_number(static_cast<uint64_t>(N));
+        }
+        // LCOV_EXCL_STOP
+
+        // step 3: write the values
+        if (N != 0)
+        {
+            oa->write_characters(reinterpret_cast<const CharType*>(values), N);
+        }
+    }
+
+    /*!
+    @brief write an array of doubles as a MessagePack extension of type
+           @ref msgpack_float64_array_type (little-endian doubles)
+
+    @param[in] values  the values
+    @param[in] count   the number of values
+    */
+    void write_msgpack_typed_array(const double* values, const std::size_t count)
+    {
+        // step 1: write control byte, the payload length and the type
+        const auto N = count * sizeof(double);
+        if (N <= (std::numeric_limits<uint8_t>::max)())
+        {
+            oa->write_character(static_cast<CharType>(0xC7)); // ext 8
+            write_number(static_cast<uint8_t>(N));
+        }
+        else if (N <= (std::numeric_limits<uint16_t>::max)())
+        {
+            oa->write_character(static_cast<CharType>(0xC8)); // ext 16
+            write_number(static_cast<uint16_t>(N));
+        }
+        else
+        {
+            oa->write_character(static_cast<CharType>(0xC9)); // ext 32
+            write_number(static_cast<uint32_t>(N));
+        }
+        oa->write_character(static_cast<CharType>(msgpack_float64_array_type));
+
+        // step 2: write the values
+        write_doubles(values, count, true);
+    }
+
+    /*!
+    @brief write an array of doubles as an optimized UBJSON array of type 'D'
+           (big-endian doubles)
+
+    @param[in] values  the values
+    @param[in] count   the number of values
+    */
+    void write_ubjson_typed_array(const double* values, const std::size_t count)
+    {
+        oa->write_character(static_cast<CharType>('['));
+        oa->write_character(static_cast<CharType>('$'));
+        oa->write_character(static_cast<CharType>('D'));
+        oa->write_character(static_cast<CharType>('#'));
+        write_number_with_ubjson_prefix(count, true);
+        write_doubles(values, count, false);
+    }
+
   private:
     /*
     @brief write a number to output input
@@ -704,6 +806,37 @@ class binary_writer
         oa->write_characters(vec.data(), sizeof(NumberType));
     }
 
+    /*
+    @brief write doubles in the given byte order
+
+    Doubles in host byte order are written at once; otherwise they are
+    reordered through a small buffer.
+    */
+    void write_doubles(const double* values, const std::size_t count, const bool little_endian)
+    {
+        if (little_endian == is_little_endian)
+        {
+            if (count != 0)
+            {
+                oa->write_characters(reinterpret_cast<const CharType*>(values), count * sizeof(double));
+            }
+            return;
+        }
+
+        std::array<CharType, 64 * sizeof(double)> buffer;
+        for (std::size_t i = 0; i < count;)
+        {
+            std::size_t size = 0;
+            for (; i < count and size < buffer.size(); ++i, size += sizeof(double))
+            {
+                std::memcpy(&buffer[size], &values[i], sizeof(double));
+                std::reverse(buffer.begin() + static_cast<std::ptrdiff_t>(size),
+                             buffer.begin() + static_cast<std::ptrdiff_t>(size + sizeof(double)));
+            }
+            oa->write_characters(buffer.data(), size);
+        }
+    }
+
     // UBJSON: write number (floating point)
     template<typename NumberType, typename std::enable_if<
                  std::is_floating_point<NumberType>::value, int>::type = 0>
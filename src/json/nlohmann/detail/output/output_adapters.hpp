@@ -1,14 +1,17 @@
 #pragma once
 
-#include <algorithm> // copy
+#include <array> // array
 #include <cstddef> // size_t
+#include <cstring> // memcpy
 #include <ios> // streamsize
-#include <iterator> // back_inserter
 #include <memory> // shared_ptr, make_shared
 #include <ostream> // basic_ostream
 #include <string> // basic_string
+#include <utility> // move
 #include <vector> // vector
 
+#include <nlohmann/detail/macro_scope.hpp>
+
 namespace nlohmann
 {
 namespace detail
@@ -39,7 +42,7 @@ class output_vector_adapter : public output_adapter_protocol<CharType>
 
     void write_characters(const CharType* s, std::size_t length) override
     {
-        std::copy(s, s + length, std::back_inserter(v));
+        v.insert(v.end(), s, s + length);
     }
 
   private:
@@ -88,6 +91,63 @@ class output_string_adapter : public output_adapter_protocol<CharType>
     StringType& str;
 };
 
+/*!
+@brief a buffer in front of an output adapter
+
+Writes are copied into a fixed buffer, which is handed to the adapter when it
+is full and on @ref flush, so that writing a character is not a virtual call
+and the target (e.g., a string or a vector) grows in large steps.
+*/
+template<typename CharType>
+class buffered_output
+{
+  public:
+    explicit buffered_output(output_adapter_t<CharType> adapter) : oa(std::move(adapter)) {}
+
+    void write_character(CharType c)
+    {
+        if (JSON_UNLIKELY(size == buffer.size()))
+        {
+            flush();
+        }
+        buffer[size++] = c;
+    }
+
+    void write_characters(const CharType* s, std::size_t length)
+    {
+        if (length > buffer.size() - size)
+        {
+            flush();
+            if (length >= buffer.size())
+            {
+                // large writes bypass the buffer
+                oa->write_characters(s, length);
+                return;
+            }
+        }
+        std::memcpy(buffer.data() + size, s, length * sizeof(CharType));
+        size += length;
+    }
+
+    /// hand the buffered characters to the output adapter
+    void flush()
+    {
+        if (size != 0)
+        {
+            oa->write_characters(buffer.data(), size);
+            size = 0;
+        }
+    }
+
+  private:
+    /// the output adapter
+    output_adapter_t<CharType> oa = nullptr;
+    /// the buffered characters
+    std::array<CharType, 4096> buffer;
+    /// the number of buffered characters
+    std::size_t size = 0;
+};
+
 template<typename CharType, typename StringType = std::basic_string<CharType>>
 class output_adapter
 {
@@ -1,14 +1,15 @@
 #pragma once
 
-#include <algorithm> // reverse, remove, fill, find, none_of
+#include <algorithm> // remove, fill, find, none_of
 #include <array> // array
 #include <cassert> // assert
 #include <ciso646> // and, or
 #include <clocale> // localeconv, lconv
-#include <cmath> // labs, isfinite, isnan, signbit
+#include <cmath> // isfinite, isnan, signbit
 #include <cstddef> // size_t, ptrdiff_t
 #include <cstdint> // uint8_t
 #include <cstdio> // snprintf
+#include <cstdlib> // strtold
 #include <iomanip> // setfill
 #include <iterator> // next
 #include <limits> // numeric_limits
@@ -16,6 +17,10 @@
 #include <sstream> // stringstream
 #include <type_traits> // is_same
 
+#if defined(__SSE2__)
+    #include <emmintrin.h> // _mm_loadu_si128, _mm_cmpeq_epi8, _mm_cmplt_epi8, _mm_movemask_epi8
+#endif
+
 #include <nlohmann/detail/exceptions.hpp>
 #include <nlohmann/detail/conversions/to_chars.hpp>
 #include <nlohmann/detail/macro_scope.hpp>
@@ -78,6 +83,17 @@ class serializer
               const bool ensure_ascii,
               const unsigned int indent_step,
               const unsigned int current_indent = 0)
+    {
+        dump_value(val, pretty_print, ensure_ascii, indent_step, current_indent);
+        o.flush();
+    }
+
+  private:
+    /// serialize @a val and its elements to the output buffer (see @ref dump)
+    void dump_value(const BasicJsonType& val, const bool pretty_print,
+                    const bool ensure_ascii,
+                    const unsigned int indent_step,
+                    const unsigned int current_indent)
     {
         switch (val.m_type)
         {
@@ -85,13 +101,13 @@ class serializer
             {
                 if (val.m_value.object->empty())
                 {
-                    o->write_characters("{}", 2);
+                    o.write_characters("{}", 2);
                     return;
                 }
 
                 if (pretty_print)
                 {
-                    o->write_characters("{\n", 2);
+                    o.write_characters("{\n", 2);
 
                     // variable to hold indentation for recursive calls
                     const auto new_indent = current_indent + indent_step;
@@ -104,51 +120,51 @@ class serializer
                     auto i = val.m_value.object->cbegin();
                     for (std::size_t cnt = 0; cnt < val.m_value.object->size() - 1; ++cnt, ++i)
                     {
-                        o->write_characters(indent_string.c_str(), new_indent);
-                        o->write_character('\"');
+                        o.write_characters(indent_string.c_str(), new_indent);
+                        o.write_character('\"');
                         dump_escaped(i->first, ensure_ascii);
-                        o->write_characters("\": ", 3);
-                        dump(i->second, true, ensure_ascii, indent_step, new_indent);
-                        o->write_characters(",\n", 2);
+                        o.write_characters("\": ", 3);
+                        dump_value(i->second, true, ensure_ascii, indent_step, new_indent);
+                        o.write_characters(",\n", 2);
                     }
 
                     // last element
                     assert(i != val.m_value.object->cend());
                     assert(std::next(i) == val.m_value.object->cend());
-                    o->write_characters(indent_string.c_str(), new_indent);
-                    o->write_character('\"');
+                    o.write_characters(indent_string.c_str(), new_indent);
+                    o.write_character('\"');
                     dump_escaped(i->first, ensure_ascii);
-                    o->write_characters("\": ", 3);
-                    dump(i->second, true, ensure_ascii, indent_step, new_indent);
+                    o.write_characters("\": ", 3);
+                    dump_value(i->second, true, ensure_ascii, indent_step, new_indent);
 
-                    o->write_character('\n');
-                    o->write_characters(indent_string.c_str(), current_indent);
-                    o->write_character('}');
+                    o.write_character('\n');
+                    o.write_characters(indent_string.c_str(), current_indent);
+                    o.write_character('}');
                 }
                 else
                 {
-                    o->write_character('{');
+                    o.write_character('{');
 
                     // first n-1 elements
                     auto i = val.m_value.object->cbegin();
                     for (std::size_t cnt = 0; cnt < val.m_value.object->size() - 1; ++cnt, ++i)
                     {
-                        o->write_character('\"');
+                        o.write_character('\"');
                         dump_escaped(i->first, ensure_ascii);
-                        o->write_characters("\":", 2);
-                        dump(i->second, false, ensure_ascii, indent_step, current_indent);
-                        o->write_character(',');
+                        o.write_characters("\":", 2);
+                        dump_value(i->second, false, ensure_ascii, indent_step, current_indent);
+                        o.write_character(',');
                     }
 
                     // last element
                     assert(i != val.m_value.object->cend());
                     assert(std::next(i) == val.m_value.object->cend());
-                    o->write_character('\"');
+                    o.write_character('\"');
                     dump_escaped(i->first, ensure_ascii);
-                    o->write_characters("\":", 2);
-                    dump(i->second, false, ensure_ascii, indent_step, current_indent);
+                    o.write_characters("\":", 2);
+                    dump_value(i->second, false, ensure_ascii, indent_step, current_indent);
 
-                    o->write_character('}');
+                    o.write_character('}');
                 }
 
                 return;
@@ -158,13 +174,13 @@ class serializer
             {
                 if (val.m_value.array->empty())
                 {
-                    o->write_characters("[]", 2);
+                    o.write_characters("[]", 2);
                     return;
                 }
 
                 if (pretty_print)
                 {
-                    o->write_characters("[\n", 2);
+                    o.write_characters("[\n", 2);
 
                     // variable to hold indentation for recursive calls
                     const auto new_indent = current_indent + indent_step;
@@ -177,37 +193,37 @@ class serializer
                     for (auto i = val.m_value.array->cbegin();
                             i != val.m_value.array->cend() - 1; ++i)
                     {
-                        o->write_characters(indent_string.c_str(), new_indent);
-                        dump(*i, true, ensure_ascii, indent_step, new_indent);
-                        o->write_characters(",\n", 2);
+                        o.write_characters(indent_string.c_str(), new_indent);
+                        dump_value(*i, true, ensure_ascii, indent_step, new_indent);
+                        o.write_characters(",\n", 2);
                     }
 
                     // last element
                     assert(not val.m_value.array->empty());
-                    o->write_characters(indent_string.c_str(), new_indent);
-                    dump(val.m_value.array->back(), true, ensure_ascii, indent_step, new_indent);
+                    o.write_characters(indent_string.c_str(), new_indent);
+                    dump_value(val.m_value.array->back(), true, ensure_ascii, indent_step, new_indent);
 
-                    o->write_character('\n');
-                    o->write_characters(indent_string.c_str(), current_indent);
-                    o->write_character(']');
+                    o.write_character('\n');
+                    o.write_characters(indent_string.c_str(), current_indent);
+                    o.write_character(']');
                 }
                 else
                 {
-                    o->write_character('[');
+                    o.write_character('[');
 
                     // first n-1 elements
                     for (auto i = val.m_value.array->cbegin();
                             i != val.m_value.array->cend() - 1; ++i)
                     {
-                        dump(*i, false, ensure_ascii, indent_step, current_indent);
-                        o->write_character(',');
+                        dump_value(*i, false, ensure_ascii, indent_step, current_indent);
+                        o.write_character(',');
                     }
 
                     // last element
                     assert(not val.m_value.array->empty());
-                    dump(val.m_value.array->back(), false, ensure_ascii, indent_step, current_indent);
+                    dump_value(val.m_value.array->back(), false, ensure_ascii, indent_step, current_indent);
 
-                    o->write_character(']');
+                    o.write_character(']');
                 }
 
                 return;
@@ -215,9 +231,9 @@ class serializer
 
             case value_t::string:
             {
-                o->write_character('\"');
+                o.write_character('\"');
                 dump_escaped(*val.m_value.string, ensure_ascii);
-                o->write_character('\"');
+                o.write_character('\"');
                 return;
             }
 
@@ -225,11 +241,11 @@ class serializer
             {
                 if (val.m_value.boolean)
                 {
-                    o->write_characters("true", 4);
+                    o.write_characters("true", 4);
                 }
                 else
                 {
-                    o->write_characters("false", 5);
+                    o.write_characters("false", 5);
                 }
                 return;
             }
@@ -254,19 +270,18 @@ class serializer
 
             case value_t::discarded:
             {
-                o->write_characters("<discarded>", 11);
+                o.write_characters("<discarded>", 11);
                 return;
             }
 
             case value_t::null:
             {
-                o->write_characters("null", 4);
+                o.write_characters("null", 4);
                 return;
             }
         }
     }
 
-  private:
     /*!
     @brief dump escaped string
 
@@ -289,6 +304,26 @@ class serializer
 
         for (std::size_t i = 0; i < s.size(); ++i)
         {
+            if (state == UTF8_ACCEPT)
+            {
+                // copy the characters that need no escaping at once
+                const std::size_t run = count_unescaped(s.data() + i, s.size() - i);
+                if (run != 0)
+                {
+                    if (bytes > 0)
+                    {
+                        o.write_characters(string_buffer.data(), bytes);
+                        bytes = 0;
+                    }
+                    o.write_characters(s.data() + i, run);
+                    i += run;
+                    if (i == s.size())
+                    {
+                        break;
+                    }
+                }
+            }
+
             const auto byte = static_cast<uint8_t>(s[i]);
 
             switch (decode(state, codepoint, byte))
@@ -381,7 +416,7 @@ class serializer
                     // written ("\uxxxx\uxxxx\0") for one code point
                     if (string_buffer.size() - bytes < 13)
                     {
-                        o->write_characters(string_buffer.data(), bytes);
+                        o.write_characters(string_buffer.data(), bytes);
                         bytes = 0;
                     }
                     break;
@@ -411,7 +446,7 @@ class serializer
             // write buffer
             if (bytes > 0)
             {
-                o->write_characters(string_buffer.data(), bytes);
+                o.write_characters(string_buffer.data(), bytes);
             }
         }
         else
@@ -423,11 +458,53 @@ class serializer
         }
     }
 
+    /*!
+    @brief count the leading characters that are written as they are
+
+    @param[in] first   the characters
+    @param[in] length  the number of characters
+    @return the number of leading printable ASCII characters other than
+            quotation mark, reverse solidus and DEL (which ensure_ascii escapes)
+    */
+    static std::size_t count_unescaped(const char* first, const std::size_t length) noexcept
+    {
+        std::size_t i = 0;
+#if defined(__SSE2__)
+        const __m128i quote = _mm_set1_epi8('\"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i control = _mm_set1_epi8(0x20);
+        const __m128i del = _mm_set1_epi8(0x7F);
+        for (; length - i >= 16; i += 16)
+        {
+            const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+            // a signed comparison catches both control (< 0x20) and
+            // non-ASCII (>= 0x80) characters
+            const int mask = _mm_movemask_epi8(_mm_or_si128(
+                                                   _mm_or_si128(_mm_cmpeq_epi8(chars, quote), _mm_cmpeq_epi8(chars, backslash)),
+                                                   _mm_or_si128(_mm_cmplt_epi8(chars, control), _mm_cmpeq_epi8(chars, del))));
+            if (mask != 0)
+            {
+                return i + static_cast<std::size_t>(__builtin_ctz(static_cast<unsigned int>(mask)));
+            }
+        }
+#endif
+        for (; i < length; ++i)
+        {
+            const auto c = static_cast<uint8_t>(first[i]);
+            if (c < 0x20 or c >= 0x7F or c == '\"' or c == '\\')
+            {
+                break;
+            }
+        }
+        return i;
+    }
+
     /*!
     @brief dump an integer
 
     Dump a given integer to output stream @a o. Works internally with
-    @a number_buffer.
+    @a number_buffer: the number of digits is determined first, and the digits
+    are then written from the end, two at a time, from a table.
 
     @param[in] x  integer number (signed or unsigned) to dump
     @tparam NumberType either @a number_integer_t or @a number_unsigned_t
@@ -438,35 +515,93 @@ class serializer
                  int> = 0>
     void dump_integer(NumberType x)
     {
+        // the two digits of 00..99
+        static const char digits_to_99[] =
+            "00010203040506070809"
+            "10111213141516171819"
+            "20212223242526272829"
+            "30313233343536373839"
+            "40414243444546474849"
+            "50515253545556575859"
+            "60616263646566676869"
+            "70717273747576777879"
+            "80818283848586878889"
+            "90919293949596979899";
+
         // special case for "0"
         if (x == 0)
         {
-            o->write_character('0');
+            o.write_character('0');
             return;
         }
 
         const bool is_negative = (x <= 0) and (x != 0);  // see issue #755
-        std::size_t i = 0;
+        // -(x + 1) + 1 does not overflow for the minimal value
+        number_unsigned_t abs_value = is_negative
+                                      ? static_cast<number_unsigned_t>(-(x + 1)) + 1
+                                      : static_cast<number_unsigned_t>(x);
+        const std::size_t n_chars = count_digits(abs_value) + (is_negative ? 1 : 0);
 
-        while (x != 0)
-        {
-            // spare 1 byte for '\0'
-            assert(i < number_buffer.size() - 1);
+        // spare 1 byte for '\0'
+        assert(n_chars < number_buffer.size() - 1);
 
-            const auto digit = std::labs(static_cast<long>(x % 10));
-            number_buffer[i++] = static_cast<char>('0' + digit);
-            x /= 10;
+        char* buffer_ptr = number_buffer.data() + n_chars;
+        while (abs_value >= 100)
+        {
+            const auto digits_index = static_cast<std::size_t>(2 * (abs_value % 100));
+            abs_value /= 100;
+            *(--buffer_ptr) = digits_to_99[digits_index + 1];
+            *(--buffer_ptr) = digits_to_99[digits_index];
+        }
+        if (abs_value >= 10)
+        {
+            const auto digits_index = static_cast<std::size_t>(2 * abs_value);
+            *(--buffer_ptr) = digits_to_99[digits_index + 1];
+            *(--buffer_ptr) = digits_to_99[digits_index];
+        }
+        else
+        {
+            *(--buffer_ptr) = static_cast<char>('0' + abs_value);
         }
 
         if (is_negative)
         {
-            // make sure there is capacity for the '-'
-            assert(i < number_buffer.size() - 2);
-            number_buffer[i++] = '-';
+            *(--buffer_ptr) = '-';
         }
 
-        std::reverse(number_buffer.begin(), number_buffer.begin() + i);
-        o->write_characters(number_buffer.data(), i);
+        o.write_characters(number_buffer.data(), n_chars);
+    }
+
+    /*!
+    @brief count the decimal digits of a number
+
+    @param[in] x  unsigned integer number
+    @return the number of decimal digits of @a x (1 for 0)
+    */
+    static std::size_t count_digits(number_unsigned_t x) noexcept
+    {
+        std::size_t n_digits = 1;
+        for (;;)
+        {
+            if (x < 10)
+            {
+                return n_digits;
+            }
+            if (x < 100)
+            {
+                return n_digits + 1;
+            }
+            if (x < 1000)
+            {
+                return n_digits + 2;
+            }
+            if (x < 10000)
+            {
+                return n_digits + 3;
+            }
+            x = x / 10000u;
+            n_digits += 4;
+        }
     }
 
     /*!
@@ -482,13 +617,13 @@ class serializer
         // NaN / inf
         if (not std::isfinite(x))
         {
-            o->write_characters("null", 4);
+            o.write_characters("null", 4);
             return;
         }
 
         // If number_float_t is an IEEE-754 single or double precision number,
-        // use the Grisu2 algorithm to produce short numbers which are
-        // guaranteed to round-trip, using strtof and strtod, resp.
+        // use the Ryu algorithm to produce the shortest numbers that are
+        // guaranteed to round-trip, i.e. that the lexer reads back exactly.
         //
         // NB: The test below works if <long double> == <double>.
         static constexpr bool is_ieee_single_or_double
@@ -503,16 +638,31 @@ class serializer
         char* begin = number_buffer.data();
         char* end = ::nlohmann::detail::to_chars(begin, begin + number_buffer.size(), x);
 
-        o->write_characters(begin, static_cast<size_t>(end - begin));
+        o.write_characters(begin, static_cast<size_t>(end - begin));
     }
 
     void dump_float(number_float_t x, std::false_type /*is_ieee_single_or_double*/)
     {
-        // get number of digits for a float -> text -> float round-trip
-        static constexpr auto d = std::numeric_limits<number_float_t>::max_digits10;
+        // find the shortest precision for a float -> text -> float
+        // round-trip; if a precision round-trips, so do all larger ones
+        int low = 1;
+        int high = std::numeric_limits<number_float_t>::max_digits10;
+        while (low < high)
+        {
+            const int precision = low + (high - low) / 2;
+            if (print_float(x, precision) > 0 and
+                    static_cast<number_float_t>(std::strtold(number_buffer.data(), nullptr)) == x)
+            {
+                high = precision;
+            }
+            else
+            {
+                low = precision + 1;
+            }
+        }
 
         // the actual conversion
-        std::ptrdiff_t len = snprintf(number_buffer.data(), number_buffer.size(), "%.*g", d, x);
+        std::ptrdiff_t len = print_float(x, high);
 
         // negative value indicates an error
         assert(len > 0);
@@ -539,7 +689,7 @@ class serializer
             }
         }
 
-        o->write_characters(number_buffer.data(), static_cast<std::size_t>(len));
+        o.write_characters(number_buffer.data(), static_cast<std::size_t>(len));
 
         // determine if need to append ".0"
         const bool value_is_int_like =
@@ -551,10 +701,18 @@ class serializer
 
         if (value_is_int_like)
         {
-            o->write_characters(".0", 2);
+            o.write_characters(".0", 2);
         }
     }
 
+    /// print @a x with the given precision to @a number_buffer, using the
+    /// current locale
+    int print_float(const number_float_t x, const int precision)
+    {
+        return std::snprintf(number_buffer.data(), number_buffer.size(), "%.*Lg",
+                             precision, static_cast<long double>(x));
+    }
+
     /*!
     @brief check whether a string is UTF-8 encoded
 
@@ -610,7 +768,7 @@ class serializer
 
   private:
     /// the output of the serializer
-    output_adapter_t<char> o = nullptr;
+    buffered_output<char> o;
 
     /// a (hopefully) large enough character buffer
     std::array<char, 64> number_buffer{{}};
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cmath> // ldexp
+#include <cstddef> // size_t
+#include <cstdint> // uint8_t, uint16_t, uint32_t, uint64_t, int64_t
+#include <cstring> // memcpy
+#include <limits> // numeric_limits
+
+namespace nlohmann
+{
+namespace detail
+{
+//////////////////
+// typed arrays //
+//////////////////
+
+/*!
+@brief the MessagePack extension type of packed double arrays
+
+The payload of such an extension is a sequence of IEEE 754 double-precision
+numbers in little-endian byte order, so that it can be written and read with
+a single copy on little-endian hosts.
+*/
+constexpr std::int8_t msgpack_float64_array_type = 0x44; // 'D'
+
+/// the layout of the elements of a CBOR typed array (RFC 8746)
+struct typed_array_type
+{
+    /// the size of an element, in bytes
+    std::size_t element_size;
+    /// whether the elements are IEEE 754 floating-point numbers
+    bool is_float;
+    /// whether the elements are signed integers
+    bool is_signed;
+    /// whether the elements are little-endian
+    bool is_little_endian;
+};
+
+/// determine whether the host is little-endian
+inline bool is_little_endian_host() noexcept
+{
+    const std::uint16_t number = 1;
+    std::uint8_t first_byte;
+    std::memcpy(&first_byte, &number, 1);
+    return first_byte == 1;
+}
+
+/// return the CBOR tag of typed arrays of doubles in host byte order
+inline std::uint8_t cbor_float64_array_tag() noexcept
+{
+    return is_little_endian_host() ? 86 : 82;
+}
+
+/*!
+@brief determine the element layout of a CBOR typed array
+
+The tags 64..87 of RFC 8746 are bit fields `0b010_f_s_e_ll`: `f` for floats,
+`s` for signed integers, `e` for little-endian elements, and `ll` for the
+element size (1, 2, 4 or 8 bytes for integers, 2, 4, 8 or 16 bytes for
+floats).
+
+@param[in] tag    the tag of a byte string
+@param[out] type  the element layout
+
+@return whether the tag denotes a supported typed array; the reserved tag 76
+        and 128-bit floats are not supported
+*/
+inline bool get_cbor_typed_array_type(const std::uint64_t tag, typed_array_type& type) noexcept
+{
+    if (tag < 64 or tag > 87 or tag == 76 or tag == 83 or tag == 87)
+    {
+        return false;
+    }
+    const auto bits = static_cast<unsigned>(tag - 64);
+    type.is_float = (bits & 0x10) != 0;
+    type.is_signed = (bits & 0x08) != 0;
+    type.is_little_endian = (bits & 0x04) != 0;
+    type.element_size = (type.is_float ? 2u : 1u) << (bits & 0x03);
+    return true;
+}
+
+/// return the element layout of MessagePack packed double arrays
+inline typed_array_type msgpack_float64_array_layout() noexcept
+{
+    return {8, true, false, true};
+}
+
+/// return the bits of the given element, sign-extended for signed integers
+inline std::uint64_t get_typed_array_bits(const typed_array_type& type,
+        const std::uint8_t* element) noexcept
+{
+    std::uint64_t bits = 0;
+    for (std::size_t i = 0; i < type.element_size; ++i)
+    {
+        const std::size_t index = type.is_little_endian ? type.element_size - 1 - i : i;
+        bits = (bits << 8) | element[index];
+    }
+    if (type.is_signed and type.element_size < 8)
+    {
+        const unsigned shift = static_cast<unsigned>(64 - 8 * type.element_size);
+        bits = static_cast<std::uint64_t>(static_cast<std::int64_t>(bits << shift) >> shift);
+    }
+    return bits;
+}
+
+/// return the value of the given element
+inline double get_typed_array_element(const typed_array_type& type,
+                                      const std::uint8_t* element) noexcept
+{
+    const std::uint64_t bits = get_typed_array_bits(type, element);
+    if (not type.is_float)
+    {
+        return type.is_signed ? static_cast<double>(static_cast<std::int64_t>(bits))
+               : static_cast<double>(bits);
+    }
+
+    switch (type.element_size)
+    {
+        case 2:
+        {
+            // code from RFC 7049, Appendix D, Figure 3
+            const int exp = static_cast<int>(bits >> 10) & 0x1F;
+            const int mant = static_cast<int>(bits) & 0x3FF;
+            double val;
+            if (exp == 0)
+            {
+                val = std::ldexp(mant, -24);
+            }
+            else if (exp != 31)
+            {
+                val = std::ldexp(mant + 1024, exp - 25);
+            }
+            else
+            {
+                val = (mant == 0) ? std::numeric_limits<double>::infinity()
+                      : std::numeric_limits<double>::quiet_NaN();
+            }
+            return (bits & 0x8000) != 0 ? -val : val;
+        }
+
+        case 4:
+        {
+            const auto number_bits = static_cast<std::uint32_t>(bits);
+            float number;
+            std::memcpy(&number, &number_bits, sizeof(number));
+            return static_cast<double>(number);
+        }
+
+        default:
+        {
+            double number;
+            std::memcpy(&number, &bits, sizeof(number));
+            return number;
+        }
+    }
+}
+
+/*!
+@brief convert the elements of a typed array to doubles
+
+Arrays of doubles in host byte order are copied at once.
+
+@param[in] type    the element layout
+@param[in] data    the elements
+@param[in] count   the number of elements
+@param[out] result receives @a count doubles
+*/
+inline void read_typed_array(const typed_array_type& type, const std::uint8_t* data,
+                             const std::size_t count, double* result) noexcept
+{
+    if (count == 0)
+    {
+        return;
+    }
+    if (type.is_float and type.element_size == sizeof(double)
+            and type.is_little_endian == is_little_endian_host())
+    {
+        std::memcpy(result, data, count * sizeof(double));
+        return;
+    }
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        result[i] = get_typed_array_element(type, data + i * type.element_size);
+    }
+}
+}
+}
@@ -0,0 +1,354 @@
+#pragma once
+
+#include <algorithm> // lower_bound
+#include <functional> // less
+#include <initializer_list> // initializer_list
+#include <memory> // allocator, allocator_traits
+#include <stdexcept> // out_of_range
+#include <utility> // forward, move, pair
+#include <vector> // vector
+
+#include <nlohmann/detail/macro_scope.hpp>
+
+namespace nlohmann
+{
+/*!
+@brief an associative container that stores its elements in a sorted vector
+
+This container can be used as @a ObjectType of @ref basic_json (see @ref
+flat_json). It keeps the members of an object in a single vector, sorted by
+key, and looks keys up by binary search. Where `std::map` allocates one tree
+node per member, a flat_map allocates once for all members, which are then
+adjacent in memory; this suits the small objects of messages. Members are
+iterated in the same order as with `std::map`, so serialized objects are the
+same.
+
+Members inserted in ascending key order (e.g., those of a serialized object)
+are appended to the vector; any other member is inserted in place, at a cost
+linear in the size of the object.
+
+@note Unlike with `std::map`, inserting or erasing a member invalidates the
+      iterators and references to the other members.
+@note The keys of the stored pairs are not `const`, so that members can be
+      moved within the vector; they must not be modified through iterators.
+
+@tparam Key        the key type
+@tparam T          the mapped type
+@tparam Compare    the key comparison
+@tparam Allocator  the allocator, which is rebound to @ref value_type
+*/
+template<class Key, class T, class Compare = std::less<Key>,
+         class Allocator = std::allocator<std::pair<const Key, T>>>
+class flat_map
+{
+  public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<Key, T>;
+    using key_compare = Compare;
+    using allocator_type =
+        typename std::allocator_traits<Allocator>::template rebind_alloc<value_type>;
+
+  private:
+    using container_type = std::vector<value_type, allocator_type>;
+
+  public:
+    using size_type = typename container_type::size_type;
+    using difference_type = typename container_type::difference_type;
+    using reference = value_type&;
+    using const_reference = const value_type&;
+    using pointer = typename container_type::pointer;
+    using const_pointer = typename container_type::const_pointer;
+    using iterator = typename container_type::iterator;
+    using const_iterator = typename container_type::const_iterator;
+
+    flat_map() = default;
+
+    explicit flat_map(const allocator_type& alloc) : m_members(alloc) {}
+
+    template<class InputIt>
+    flat_map(InputIt first, InputIt last)
+    {
+        insert(first, last);
+    }
+
+    flat_map(std::initializer_list<value_type> init)
+    {
+        insert(init.begin(), init.end());
+    }
+
+    /////////////////////
+    // iterators
+    /////////////////////
+
+    iterator begin() noexcept
+    {
+        return m_members.begin();
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return m_members.begin();
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return m_members.cbegin();
+    }
+
+    iterator end() noexcept
+    {
+        return m_members.end();
+    }
+
+    const_iterator end() const noexcept
+    {
+        return m_members.end();
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return m_members.cend();
+    }
+
+    /////////////////////
+    // capacity
+    /////////////////////
+
+    bool empty() const noexcept
+    {
+        return m_members.empty();
+    }
+
+    size_type size() const noexcept
+    {
+        return m_members.size();
+    }
+
+    size_type max_size() const noexcept
+    {
+        return m_members.max_size();
+    }
+
+    /// reserves storage for @a count members
+    void reserve(size_type count)
+    {
+        m_members.reserve(count);
+    }
+
+    /////////////////////
+    // lookup
+    /////////////////////
+
+    iterator find(const key_type& key)
+    {
+        const auto it = lower_bound(key);
+        return (it != end() and not key_comp()(key, it->first)) ? it : end();
+    }
+
+    const_iterator find(const key_type& key) const
+    {
+        const auto it = lower_bound(key);
+        return (it != end() and not key_comp()(key, it->first)) ? it : end();
+    }
+
+    size_type count(const key_type& key) const
+    {
+        return (find(key) == end()) ? 0 : 1;
+    }
+
+    /// @throw std::out_of_range if there is no member with the given key
+    mapped_type& at(const key_type& key)
+    {
+        const auto it = find(key);
+        if (JSON_UNLIKELY(it == end()))
+        {
+            JSON_THROW(std::out_of_range("flat_map::at"));
+        }
+        return it->second;
+    }
+
+    /// @throw std::out_of_range if there is no member with the given key
+    const mapped_type& at(const key_type& key) const
+    {
+        const auto it = find(key);
+        if (JSON_UNLIKELY(it == end()))
+        {
+            JSON_THROW(std::out_of_range("flat_map::at"));
+        }
+        return it->second;
+    }
+
+    mapped_type& operator[](const key_type& key)
+    {
+        auto it = lower_bound(key);
+        if (it == end() or key_comp()(key, it->first))
+        {
+            it = emplace_member(it, key, mapped_type());
+        }
+        return it->second;
+    }
+
+    mapped_type& operator[](key_type&& key)
+    {
+        auto it = lower_bound(key);
+        if (it == end() or key_comp()(key, it->first))
+        {
+            it = emplace_member(it, std::move(key), mapped_type());
+        }
+        return it->second;
+    }
+
+    /////////////////////
+    // modifiers
+    /////////////////////
+
+    /*!
+    @brief inserts a member unless there already is one with the same key
+    @return an iterator to the member with the key, and whether the member
+            was inserted
+    */
+    std::pair<iterator, bool> insert(value_type&& value)
+    {
+        // members usually arrive in ascending order
+        if (m_members.empty() or key_comp()(m_members.back().first, value.first))
+        {
+            return {emplace_member(end(), std::move(value)), true};
+        }
+
+        const auto it = lower_bound(value.first);
+        if (not key_comp()(value.first, it->first))
+        {
+            return {it, false};
+        }
+        return {emplace_member(it, std::move(value)), true};
+    }
+
+    std::pair<iterator, bool> insert(const value_type& value)
+    {
+        return insert(value_type(value));
+    }
+
+    /// inserts a member; the position hint is not needed (see std::inserter)
+    iterator insert(const_iterator /*unused*/, value_type&& value)
+    {
+        return insert(std::move(value)).first;
+    }
+
+    iterator insert(const_iterator /*unused*/, const value_type& value)
+    {
+        return insert(value_type(value)).first;
+    }
+
+    template<class InputIt>
+    void insert(InputIt first, InputIt last)
+    {
+        for (; first != last; ++first)
+        {
+            insert(value_type(*first));
+        }
+    }
+
+    template<class... Args>
+    std::pair<iterator, bool> emplace(Args&& ... args)
+    {
+        return insert(value_type(std::forward<Args>(args)...));
+    }
+
+    iterator erase(const_iterator pos)
+    {
+        return m_members.erase(pos);
+    }
+
+    iterator erase(iterator pos)
+    {
+        return m_members.erase(pos);
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        return m_members.erase(first, last);
+    }
+
+    size_type erase(const key_type& key)
+    {
+        const auto it = find(key);
+        if (it == end())
+        {
+            return 0;
+        }
+        m_members.erase(it);
+        return 1;
+    }
+
+    void clear() noexcept
+    {
+        m_members.clear();
+    }
+
+    void swap(flat_map& other) noexcept
+    {
+        m_members.swap(other.m_members);
+    }
+
+    key_compare key_comp() const
+    {
+        return key_compare();
+    }
+
+    friend bool operator==(const flat_map& lhs, const flat_map& rhs)
+    {
+        return lhs.m_members == rhs.m_members;
+    }
+
+    friend bool operator!=(const flat_map& lhs, const flat_map& rhs)
+    {
+        return lhs.m_members != rhs.m_members;
+    }
+
+    friend bool operator<(const flat_map& lhs, const flat_map& rhs)
+    {
+        return lhs.m_members < rhs.m_members;
+    }
+
+  private:
+    /// the number of members storage is first allocated for
+    static constexpr size_type initial_capacity = 2;
+
+    /// constructs a member at @a pos
+    template<class... Args>
+    iterator emplace_member(iterator pos, Args&& ... args)
+    {
+        if (m_members.capacity() == 0)
+        {
+            // most objects are small; avoid growing one member at a time
+            m_members.reserve(initial_capacity);
+            pos = m_members.end();
+        }
+        return m_members.emplace(pos, std::forward<Args>(args)...);
+    }
+
+    /// returns the first member whose key is not less than @a key
+    iterator lower_bound(const key_type& key)
+    {
+        return std::lower_bound(m_members.begin(), m_members.end(), key, less_key());
+    }
+
+    const_iterator lower_bound(const key_type& key) const
+    {
+        return std::lower_bound(m_members.begin(), m_members.end(), key, less_key());
+    }
+
+    /// compares the key of a member with a key
+    struct less_key
+    {
+        bool operator()(const value_type& member, const key_type& key) const
+        {
+            return key_compare()(member.first, key);
+        }
+    };
+
+    /// the members, sorted by key
+    container_type m_members;
+};
+}
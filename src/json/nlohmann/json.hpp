@@ -46,6 +46,7 @@ SOFTWARE.
 #include <utility> // declval, forward, move, pair, swap
 
 #include <nlohmann/json_fwd.hpp>
+#include <nlohmann/flat_map.hpp>
 #include <nlohmann/detail/macro_scope.hpp>
 #include <nlohmann/detail/meta.hpp>
 #include <nlohmann/detail/exceptions.hpp>
@@ -62,11 +63,14 @@ SOFTWARE.
 #include <nlohmann/detail/iterators/json_reverse_iterator.hpp>
 #include <nlohmann/detail/output/output_adapters.hpp>
 #include <nlohmann/detail/input/binary_reader.hpp>
+#include <nlohmann/detail/input/binary_cursor.hpp>
 #include <nlohmann/detail/output/binary_writer.hpp>
 #include <nlohmann/detail/output/serializer.hpp>
 #include <nlohmann/detail/json_ref.hpp>
 #include <nlohmann/detail/json_pointer.hpp>
+#include <nlohmann/detail/compiled_json_pointer.hpp>
 #include <nlohmann/adl_serializer.hpp>
+#include <nlohmann/binary_view.hpp>
 
 /*!
 @brief namespace for Niels Lohmann
@@ -79,8 +83,8 @@ namespace nlohmann
 /*!
 @brief a class to store JSON values
 
-@tparam ObjectType type for JSON objects (`std::map` by default; will be used
-in @ref object_t)
+@tparam ObjectType type for JSON objects (`std::map` by default, or @ref
+flat_map for small objects; will be used in @ref object_t)
 @tparam ArrayType type for JSON arrays (`std::vector` by default; will be used
 in @ref array_t)
 @tparam StringType type for JSON strings and object keys (`std::string` by
@@ -163,6 +167,7 @@ class basic_json
   private:
     template<detail::value_t> friend struct detail::external_constructor;
     friend ::nlohmann::json_pointer<basic_json>;
+    friend ::nlohmann::compiled_json_pointer<basic_json>;
     friend ::nlohmann::detail::parser<basic_json>;
     friend ::nlohmann::detail::serializer<basic_json>;
     template<typename BasicJsonType>
@@ -200,10 +205,14 @@ class basic_json
     using value_t = detail::value_t;
     /// @copydoc nlohmann::json_pointer
     using json_pointer = ::nlohmann::json_pointer<basic_json>;
+    /// @copydoc nlohmann::compiled_json_pointer
+    using compiled_json_pointer = ::nlohmann::compiled_json_pointer<basic_json>;
     template<typename T, typename SFINAE>
     using json_serializer = JSONSerializer<T, SFINAE>;
     /// helper type for initializer lists of basic_json values
     using initializer_list_t = std::initializer_list<detail::json_ref<basic_json>>;
+    /// SAX interface type, see @ref nlohmann::json_sax
+    using json_sax_t = json_sax<basic_json>;
 
     ////////////////
     // exceptions //
@@ -2979,7 +2988,7 @@ class basic_json
             JSON_CATCH (std::out_of_range&)
             {
                 // create better exception explanation
-                JSON_THROW(out_of_range::create(403, "key '" + key + "' not found"));
+                JSON_THROW(out_of_range::create(403, "key '" + std::string(key.begin(), key.end()) + "' not found"));
             }
         }
         else
@@ -3030,7 +3039,7 @@ class basic_json
             JSON_CATCH (std::out_of_range&)
             {
                 // create better exception explanation
-                JSON_THROW(out_of_range::create(403, "key '" + key + "' not found"));
+                JSON_THROW(out_of_range::create(403, "key '" + std::string(key.begin(), key.end()) + "' not found"));
             }
         }
         else
@@ -6022,6 +6031,33 @@ class basic_json
         return parser(i).accept(true);
     }
 
+    /*!
+    @brief generate SAX events
+
+    The SAX event lister must follow the interface of @ref json_sax, but need
+    not derive from it; its member functions are then called without virtual
+    dispatch. No DOM is built, and no exceptions are thrown for syntax errors:
+    these are reported through the `parse_error` event instead.
+
+    @param[in] i  input to read from
+    @param[in,out] sax  SAX event listener
+    @param[in] strict  whether the input has to be consumed completely
+
+    @return return value of the last processed SAX event, i.e. whether the
+            input was read completely
+
+    @complexity Linear in the length of the input. The parser is a predictive
+    LL(1) parser. The complexity can be higher if the SAX consumer @a sax has
+    a super-linear complexity.
+
+    @note A UTF-8 byte order mark is silently ignored.
+    */
+    template<typename SAX>
+    static bool sax_parse(detail::input_adapter i, SAX* sax, const bool strict = true)
+    {
+        return parser(i).sax_parse(sax, strict);
+    }
+
     /*!
     @brief deserialize from an iterator range with contiguous storage
 
@@ -6518,6 +6554,94 @@ class basic_json
         binary_writer<char>(o).write_ubjson(j, use_size, use_type);
     }
 
+    /*!
+    @brief create a CBOR typed array of doubles
+
+    Serializes an array of doubles as a CBOR typed array (RFC 8746): a byte
+    string tagged as doubles in host byte order (tag 86 on little-endian
+    hosts, 82 on big-endian ones). Unlike serializing an array value with
+    @ref to_cbor(const basic_json&), this involves no JSON value per element,
+    and the doubles are copied at once.
+
+    @param[in] values  the values
+    @param[in] count   the number of values
+    @return CBOR serialization as byte vector
+
+    @complexity Linear in @a count.
+
+    @sa @ref from_cbor(detail::input_adapter, const bool strict), which reads
+        typed arrays as arrays of numbers
+    @sa @ref binary_view::get_to(double*, std::size_t) const, which reads them
+        straight into doubles
+    */
+    static std::vector<uint8_t> to_cbor_typed_array(const double* values, const std::size_t count)
+    {
+        std::vector<uint8_t> result;
+        to_cbor_typed_array(values, count, result);
+        return result;
+    }
+
+    static void to_cbor_typed_array(const double* values, const std::size_t count,
+                                    detail::output_adapter<uint8_t> o)
+    {
+        binary_writer<uint8_t>(o).write_cbor_typed_array(values, count);
+    }
+
+    /*!
+    @brief create a MessagePack typed array of doubles
+
+    Serializes an array of doubles as a MessagePack extension of type
+    @ref detail::msgpack_float64_array_type, whose payload holds the doubles in
+    little-endian byte order; on little-endian hosts, they are copied at once.
+
+    @param[in] values  the values
+    @param[in] count   the number of values
+    @return MessagePack serialization as byte vector
+
+    @complexity Linear in @a count.
+
+    @sa @ref from_msgpack(detail::input_adapter, const bool strict), which
+        reads such extensions as arrays of numbers
+    */
+    static std::vector<uint8_t> to_msgpack_typed_array(const double* values, const std::size_t count)
+    {
+        std::vector<uint8_t> result;
+        to_msgpack_typed_array(values, count, result);
+        return result;
+    }
+
+    static void to_msgpack_typed_array(const double* values, const std::size_t count,
+                                       detail::output_adapter<uint8_t> o)
+    {
+        binary_writer<uint8_t>(o).write_msgpack_typed_array(values, count);
+    }
+
+    /*!
+    @brief create a UBJSON typed array of doubles
+
+    Serializes an array of doubles as an optimized UBJSON array of type 'D'
+    and known count, as @ref to_ubjson(const basic_json&, const bool, const bool)
+    does with both flags set, but without a JSON value per element.
+
+    @param[in] values  the values
+    @param[in] count   the number of values
+    @return UBJSON serialization as byte vector
+
+    @complexity Linear in @a count.
+    */
+    static std::vector<uint8_t> to_ubjson_typed_array(const double* values, const std::size_t count)
+    {
+        std::vector<uint8_t> result;
+        to_ubjson_typed_array(values, count, result);
+        return result;
+    }
+
+    static void to_ubjson_typed_array(const double* values, const std::size_t count,
+                                      detail::output_adapter<uint8_t> o)
+    {
+        binary_writer<uint8_t>(o).write_ubjson_typed_array(values, count);
+    }
+
     /*!
     @brief create a JSON value from an input in CBOR format
 
@@ -7128,7 +7252,7 @@ class basic_json
                     case value_t::object:
                     {
                         // use operator[] to add value
-                        parent[last_path] = val;
+                        parent[json_pointer::to_key(last_path)] = val;
                         break;
                     }
 
@@ -7176,7 +7300,7 @@ class basic_json
             if (parent.is_object())
             {
                 // perform range check
-                auto it = parent.find(last_path);
+                auto it = parent.find(json_pointer::to_key(last_path));
                 if (JSON_LIKELY(it != parent.end()))
                 {
                     parent.erase(it);
@@ -7208,7 +7332,7 @@ class basic_json
                                           bool string_type) -> basic_json &
             {
                 // find value
-                auto it = val.m_value.object->find(member);
+                auto it = val.m_value.object->find(json_pointer::to_key(member));
 
                 // context-sensitive error message
                 const auto error_msg = (op == "op") ? "operation" : "operation '" + op + "'";
@@ -7229,6 +7353,15 @@ class basic_json
                 return it->second;
             };
 
+            // wrapper to get a string member as std::string, the type JSON
+            // pointers use, whatever the allocator of string values
+            const auto get_string = [&get_value](const std::string & op,
+                                                 const std::string & member)
+            {
+                const auto& value = get_value(op, member, true).template get_ref<const string_t&>();
+                return std::string(value.begin(), value.end());
+            };
+
             // type check: every element of the array must be an object
             if (JSON_UNLIKELY(not val.is_object()))
             {
@@ -7236,8 +7369,8 @@ class basic_json
             }
 
             // collect mandatory members
-            const std::string op = get_value("op", "op", true);
-            const std::string path = get_value(op, "path", true);
+            const std::string op = get_string("op", "op");
+            const std::string path = get_string(op, "path");
             json_pointer ptr(path);
 
             switch (get_op(op))
@@ -7263,7 +7396,7 @@ class basic_json
 
                 case patch_operations::move:
                 {
-                    const std::string from_path = get_value("move", "from", true);
+                    const std::string from_path = get_string("move", "from");
                     json_pointer from_ptr(from_path);
 
                     // the "from" location must exist - use at()
@@ -7280,7 +7413,7 @@ class basic_json
 
                 case patch_operations::copy:
                 {
-                    const std::string from_path = get_value("copy", "from", true);
+                    const std::string from_path = get_string("copy", "from");
                     const json_pointer from_ptr(from_path);
 
                     // the "from" location must exist - use at()
@@ -7310,7 +7443,8 @@ class basic_json
                     // throw an exception if test fails
                     if (JSON_UNLIKELY(not success))
                     {
-                        JSON_THROW(other_error::create(501, "unsuccessful: " + val.dump()));
+                        const auto text = val.dump();
+                        JSON_THROW(other_error::create(501, "unsuccessful: " + std::string(text.begin(), text.end())));
                     }
 
                     break;
@@ -7367,6 +7501,13 @@ class basic_json
         // the patch
         basic_json result(value_t::array);
 
+        // paths are std::string, like JSON pointers, while string values may
+        // use another allocator (e.g., arena-allocated messages)
+        const auto path_value = [](const std::string & p)
+        {
+            return string_t(p.begin(), p.end());
+        };
+
         // if the values are the same, return empty patch
         if (source == target)
         {
@@ -7378,7 +7519,7 @@ class basic_json
             // different types: replace value
             result.push_back(
             {
-                {"op", "replace"}, {"path", path}, {"value", target}
+                {"op", "replace"}, {"path", path_value(path)}, {"value", target}
             });
         }
         else
@@ -7409,7 +7550,7 @@ class basic_json
                         result.insert(result.begin() + end_index, object(
                         {
                             {"op", "remove"},
-                            {"path", path + "/" + std::to_string(i)}
+                            {"path", path_value(path + "/" + std::to_string(i))}
                         }));
                         ++i;
                     }
@@ -7420,7 +7561,7 @@ class basic_json
                         result.push_back(
                         {
                             {"op", "add"},
-                            {"path", path + "/" + std::to_string(i)},
+                            {"path", path_value(path + "/" + std::to_string(i))},
                             {"value", target[i]}
                         });
                         ++i;
@@ -7435,7 +7576,8 @@ class basic_json
                     for (auto it = source.cbegin(); it != source.cend(); ++it)
                     {
                         // escape the key name to be used in a JSON patch
-                        const auto key = json_pointer::escape(it.key());
+                        const auto& name = it.key();
+                        const auto key = json_pointer::escape(std::string(name.begin(), name.end()));
 
                         if (target.find(it.key()) != target.end())
                         {
@@ -7448,7 +7590,7 @@ class basic_json
                             // found a key that is not in o -> remove it
                             result.push_back(object(
                             {
-                                {"op", "remove"}, {"path", path + "/" + key}
+                                {"op", "remove"}, {"path", path_value(path + "/" + key)}
                             }));
                         }
                     }
@@ -7459,10 +7601,11 @@ class basic_json
                         if (source.find(it.key()) == source.end())
                         {
                             // found a key that is not in this -> add it
-                            const auto key = json_pointer::escape(it.key());
+                            const auto& name = it.key();
+                            const auto key = json_pointer::escape(std::string(name.begin(), name.end()));
                             result.push_back(
                             {
-                                {"op", "add"}, {"path", path + "/" + key},
+                                {"op", "add"}, {"path", path_value(path + "/" + key)},
                                 {"value", it.value()}
                             });
                         }
@@ -7476,7 +7619,7 @@ class basic_json
                     // both primitive type: replace value
                     result.push_back(
                     {
-                        {"op", "replace"}, {"path", path}, {"value", target}
+                        {"op", "replace"}, {"path", path_value(path)}, {"value", target}
                     });
                     break;
                 }
@@ -24,6 +24,9 @@ for serialization.
 template<typename = void, typename = void>
 struct adl_serializer;
 
+template<class Key, class T, class Compare, class Allocator>
+class flat_map;
+
 template<template<typename U, typename V, typename... Args> class ObjectType =
          std::map,
          template<typename U, typename... Args> class ArrayType = std::vector,
@@ -50,6 +53,15 @@ within a JSON document. It can be used with functions `at` and
 template<typename BasicJsonType>
 class json_pointer;
 
+/*!
+@brief JSON Pointer prepared for repeated lookups
+
+A compiled JSON pointer converts the reference tokens of a JSON pointer into
+object keys and array indices once, and resolves them without allocation.
+*/
+template<typename BasicJsonType>
+class compiled_json_pointer;
+
 /*!
 @brief default JSON class
 
@@ -59,6 +71,15 @@ uses the standard template types.
 @since version 1.0.0
 */
 using json = basic_json<>;
+
+/*!
+@brief JSON class with sorted-vector objects
+
+This type is the specialization of the @ref basic_json class which stores
+objects in a @ref flat_map instead of a `std::map`, i.e., with one allocation
+per object instead of one per member.
+*/
+using flat_json = basic_json<flat_map>;
 }
 
 #endif
@@ -1,17 +1,38 @@
+#include <cstring>
 #include <iostream>
+#include <string>
+#include <vector>
 #include "calculator_engine.h"
 
 using namespace std;
 
-int main()
+int main(int argc, char *argv[])
 {
   CalculatorEngine calculatorEngine;
   std::string operation;
   double operandA;
   double operandB;
   double result;
+  bool rescanPlugins = false;
+  std::vector<std::string> pluginPaths;
 
-  calculatorEngine.start();
+  for (int i = 1; i < argc; ++i) {
+    if (0 == strcmp(argv[i], "--rescan")) {
+      rescanPlugins = true;
+    }
+    else if (0 == strcmp(argv[i], "--plugin-path") && i + 1 < argc) {
+      pluginPaths.push_back(argv[++i]);
+    }
+    else {
+      cerr << "Usage: " << argv[0] << " [--rescan] [--plugin-path DIR]..." << endl;
+      return 1;
+    }
+  }
+
+  if (!pluginPaths.empty()) {
+    calculatorEngine.setPluginSearchPaths(pluginPaths);
+  }
+  calculatorEngine.start(rescanPlugins);
 
   while (true) {
     cout << "Enter operation: ";
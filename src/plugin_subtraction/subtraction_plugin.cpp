@@ -1,6 +1,48 @@
 #include "subtraction_plugin.h"
+#include "batch_kernels.h"
 #include <iostream>
 
+/**
+ * The element-wise subtraction, as used by the batch kernels.
+ */
+struct Subtraction
+{
+  static double Apply(double a, double b)
+  {
+    return a - b;
+  }
+
+#ifdef BATCH_KERNELS_X86
+  BATCH_KERNELS_TARGET("sse2")
+  static __m128d Apply(__m128d a, __m128d b)
+  {
+    return _mm_sub_pd(a, b);
+  }
+
+  BATCH_KERNELS_TARGET("avx2")
+  static __m256d Apply(__m256d a, __m256d b)
+  {
+    return _mm256_sub_pd(a, b);
+  }
+
+  BATCH_KERNELS_TARGET("avx512f")
+  static __m512d Apply(__m512d a, __m512d b)
+  {
+    return _mm512_sub_pd(a, b);
+  }
+#endif
+};
+
+/**
+ * The instruction set of the batch kernel selected for this host.
+ */
+static InstructionSet s_instructionSet = InstructionSet::Scalar;
+
+/**
+ * The batch kernel, selected once when the plugin library is loaded.
+ */
+static BatchKernel_t *s_batchKernel = BatchKernels<Subtraction>::Select(&s_instructionSet);
+
 /**
  * Constructor.
  */
@@ -30,3 +72,44 @@ double SubtractionPlugin::execute(double operandA, double operandB)
 {
   return operandA - operandB;
 }
+
+
+/**
+ * Executes the subtraction operation on a batch of operand pairs.
+ *
+ * @param operandsA The first operands
+ * @param operandsB The second operands
+ * @param results The output buffer, which receives count results
+ * @param count The number of operand pairs
+ */
+void SubtractionPlugin::executeBatch(const double *operandsA,
+                                     const double *operandsB,
+                                     double *results,
+                                     std::size_t count)
+{
+  s_batchKernel(operandsA, operandsB, results, count);
+}
+
+
+/**
+ * Gets the name of the instruction set the batch subtraction was specialized
+ * for on this host.
+ *
+ * @return The instruction set name
+ */
+const char *SubtractionPlugin::getInstructionSet() const
+{
+  return CpuFeatures::GetName(s_instructionSet);
+}
+
+
+/**
+ * Gets how the instances of this plugin may be used by concurrent threads.
+ * The subtraction keeps no state, so a single instance may be shared.
+ *
+ * @return PluginThreadSafety::Shared
+ */
+PluginThreadSafety SubtractionPlugin::getThreadSafety() const
+{
+  return PluginThreadSafety::Shared;
+}
@@ -31,15 +31,49 @@ public:
    * @return The subtraction result
    */
   virtual double execute(double operandA, double operandB) override;
+
+  /**
+   * Executes the subtraction operation on a batch of operand pairs.
+   *
+   * @param operandsA The first operands
+   * @param operandsB The second operands
+   * @param results The output buffer, which receives count results
+   * @param count The number of operand pairs
+   */
+  virtual void executeBatch(const double *operandsA,
+                            const double *operandsB,
+                            double *results,
+                            std::size_t count) override;
+
+  /**
+   * Gets the name of the instruction set the batch subtraction was specialized
+   * for on this host.
+   *
+   * @return The instruction set name
+   */
+  virtual const char *getInstructionSet() const override;
+
+  /**
+   * Gets how the instances of this plugin may be used by concurrent threads.
+   * The subtraction keeps no state, so a single instance may be shared.
+   *
+   * @return PluginThreadSafety::Shared
+   */
+  virtual PluginThreadSafety getThreadSafety() const override;
 };
 
+// The plugin metadata, which the plugin registry reads without loading the
+// plugin library.
+PLUGIN_METADATA(OPERATION_PLUGIN_TYPE, "sub", "1.0.0")
+
 // The following methods are used by the plugin registry to retrieve the 
-// plugin metadata. They are called via dlopen.
+// plugin metadata of legacy plugins, and to create/destroy plugin instances.
+// They are called via dlopen.
 
 extern "C"
 const char *getName()
 {
-  return "sub";
+  return pluginMetadata.name;
 }
 
 extern "C"
@@ -0,0 +1,185 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include "nlohmann/json.hpp"
+
+using nlohmann::json;
+using nlohmann::detail::from_chars;
+using nlohmann::detail::to_chars;
+
+/**
+ * JSON values whose numbers are single-precision floats.
+ */
+typedef nlohmann::basic_json<std::map, std::vector, std::string, bool,
+                             std::int64_t, std::uint64_t, float> float_json;
+
+/**
+ * The number of random values checked, of each floating-point type.
+ */
+#define FORMAT_VALUES 200000
+
+/**
+ * The number of failures found so far, of which the first few are printed.
+ */
+static unsigned long s_failures = 0;
+
+/**
+ * Reports a failed check.
+ */
+static void Fail(const char *what, const std::string &text)
+{
+  if (++s_failures <= 10) {
+    std::fprintf(stderr, "%s: %s\n", what, text.c_str());
+  }
+}
+
+/**
+ * Checks whether the given literal reads back as the given value.
+ */
+template<typename FloatType>
+static bool ReadsBackAs(const std::string &literal, FloatType value)
+{
+  FloatType parsed;
+  from_chars(literal.data(), literal.data() + literal.size(), parsed);
+  return parsed == value;
+}
+
+/**
+ * Checks that the given dumped number is the shortest decimal that reads
+ * back as the value. With n digits, whose last one is never 0, the value
+ * lies between the two neighbouring decimals of n - 1 digits, the digits
+ * truncated and the digits truncated plus one; neither may read back as the
+ * value.
+ */
+template<typename FloatType>
+static void CheckShortest(const std::string &text, FloatType value)
+{
+  std::string digits;
+  int exponent = 0;
+  bool point = false;
+  std::size_t i = 0;
+  for (; i < text.size() && 'e' != text[i]; ++i) {
+    if ('.' == text[i]) {
+      point = true;
+    } else if ('0' <= text[i] && text[i] <= '9') {
+      if (point) {
+        --exponent;
+      }
+      digits += text[i];
+    }
+  }
+  if (i < text.size()) {
+    exponent += std::atoi(text.c_str() + i + 1);
+  }
+  while (digits.size() > 1 && '0' == digits[digits.size() - 1]) {
+    digits.erase(digits.size() - 1);
+    ++exponent;
+  }
+  while (digits.size() > 1 && '0' == digits[0]) {
+    digits.erase(0, 1);
+  }
+  if (digits.size() < 2) {
+    return;
+  }
+
+  // The shorter neighbours, as digits * 10^(exponent + 1)
+  std::string below = digits.substr(0, digits.size() - 1);
+  std::string above = below;
+  std::size_t carry = above.size();
+  while (carry > 0 && '9' == above[carry - 1]) {
+    above[--carry] = '0';
+  }
+  if (0 == carry) {
+    above.insert(0, 1, '1');
+  } else {
+    ++above[carry - 1];
+  }
+
+  const std::string suffix = "e" + std::to_string(exponent + 1);
+  if (ReadsBackAs(below + suffix, value) || ReadsBackAs(above + suffix, value)) {
+    Fail("not the shortest decimal", text);
+  }
+}
+
+/**
+ * Checks that the given value is dumped as the shortest decimal that the
+ * lexer reads back as the same value.
+ */
+template<typename Json, typename FloatType>
+static void CheckValue(FloatType value)
+{
+  const std::string text = Json(value).dump();
+  const FloatType parsed = Json::parse(text).template get<FloatType>();
+  if (parsed != value || std::signbit(parsed) != std::signbit(value)) {
+    Fail("does not read back", text);
+  }
+  CheckShortest(text, value);
+}
+
+
+/**
+ * Checks the shortest round-trip output of the serializer for random
+ * doubles and floats (as bit patterns), subnormals, powers of two and
+ * their neighbours, and integers: each number is dumped as the shortest
+ * decimal that the lexer reads back as the same value.
+ */
+int main()
+{
+  std::mt19937_64 random(20240602);
+  for (int i = 0; i < FORMAT_VALUES; ++i) {
+    const uint64_t bits = random();
+    double d;
+    std::memcpy(&d, &bits, sizeof(d));
+    if (std::isfinite(d)) {
+      CheckValue<json>(d);
+    }
+    const uint32_t floatBits = static_cast<uint32_t>(bits >> 32);
+    float f;
+    std::memcpy(&f, &floatBits, sizeof(f));
+    if (std::isfinite(f)) {
+      CheckValue<float_json>(f);
+    }
+  }
+
+  for (int e = -1074; e <= 1023; ++e) {
+    const double power = std::ldexp(1.0, e);
+    CheckValue<json>(power);
+    CheckValue<json>(std::nextafter(power, 0.0));
+    CheckValue<json>(std::nextafter(power, HUGE_VAL));
+  }
+  for (int e = -149; e <= 127; ++e) {
+    const float power = std::ldexp(1.0f, e);
+    CheckValue<float_json>(power);
+    CheckValue<float_json>(std::nextafter(power, 0.0f));
+    CheckValue<float_json>(std::nextafter(power, HUGE_VALF));
+  }
+  for (uint64_t bits = 1; bits < 1000; ++bits) {
+    double d;
+    std::memcpy(&d, &bits, sizeof(d));
+    CheckValue<json>(d);
+    float f;
+    const uint32_t floatBits = static_cast<uint32_t>(bits);
+    std::memcpy(&f, &floatBits, sizeof(f));
+    CheckValue<float_json>(f);
+  }
+  for (int i = 1; i < 20000; ++i) {
+    CheckValue<json>(i * 0.1);
+    CheckValue<float_json>(i * 0.1f);
+  }
+  CheckValue<json>(std::numeric_limits<double>::max());
+  CheckValue<float_json>(std::numeric_limits<float>::max());
+
+  // Grisu2, used before, wrote these with one digit too many
+  if ("7.9910094597795e+259" != json(7.991009459779501e+259).dump()) {
+    Fail("known value", json(7.991009459779501e+259).dump());
+  }
+  if ("1.580782004550284e+17" != json(1.5807820045502842e+17).dump()) {
+    Fail("known value", json(1.5807820045502842e+17).dump());
+  }
+
+  std::printf("%lu failures\n", s_failures);
+  return 0 == s_failures ? 0 : 1;
+}
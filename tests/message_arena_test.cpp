@@ -0,0 +1,117 @@
+#include <cstdio>
+#include <string>
+#include "message_arena.h"
+
+/**
+ * The number of failed checks.
+ */
+static int s_failures = 0;
+
+/**
+ * Records a failed check.
+ */
+static void Check(bool condition, const char *what)
+{
+  if (!condition) {
+    std::fprintf(stderr, "check failed: %s\n", what);
+    ++s_failures;
+  }
+}
+
+/**
+ * Builds a request with long strings, so that it does not fit the small
+ * string buffer, and enough members to chain several arena blocks.
+ */
+static std::string MakeRequest(int members)
+{
+  nlohmann::json request;
+  for (int i = 0; i < members; ++i) {
+    request["member" + std::to_string(i)] = "a value that is longer than the small string buffer " + std::to_string(i);
+  }
+  return request.dump();
+}
+
+/**
+ * Parses and discards requests in a few scopes, reusing (and coalescing) the
+ * arena blocks, the way a request loop does.
+ */
+static void ParseRequests(int members)
+{
+  for (int i = 0; i < 3; ++i) {
+    MessageArena::Scope scope;
+    ArenaJson request = ArenaJson::parse(MakeRequest(members));
+    Check(static_cast<int>(request.size()) == members, "parsed request size");
+  }
+}
+
+
+/**
+ * Checks that message arena resets never reuse memory that is still
+ * referenced:
+ * - Members added during a scope to a message created outside it survive
+ *   the following scopes.
+ * - A message that outlives its scope survives following scopes, including
+ *   ones whose reset coalesces the arena blocks, and is released correctly.
+ * - Once everything is released, the arena reuses its blocks again.
+ * - JSON patches can be created and applied to arena messages.
+ */
+int main()
+{
+  MessageArena &arena = MessageArena::GetThreadArena();
+
+  {
+    ArenaJson config = ArenaJson::object();
+    {
+      MessageArena::Scope scope;
+      config["name"] = "a configuration value that is longer than the small string buffer";
+      config["limits"] = { 1, 2, 3 };
+    }
+    ParseRequests(4000);
+    Check(config.dump() == "{\"limits\":[1,2,3],\"name\":\"a configuration value that is longer than the "
+                           "small string buffer\"}", "members added in a scope");
+    config["limits"].push_back(4);
+    Check(config["limits"].size() == 4, "members modified after the scope");
+  }
+  Check(0 == arena.getLiveAllocations(), "members added in a scope are released");
+
+  ArenaJson *kept = new ArenaJson();
+  {
+    MessageArena::Scope scope;
+    *kept = ArenaJson::parse(MakeRequest(100));
+  }
+  ParseRequests(4000);
+  Check(kept->size() == 100 && (*kept)["member99"] == "a value that is longer than the small string buffer 99",
+        "message outliving its scope");
+  delete kept;
+  Check(0 == arena.getLiveAllocations(), "message outliving its scope is released");
+
+  ParseRequests(4000);
+  const std::size_t capacity = arena.getCapacity();
+  ParseRequests(4000);
+  Check(arena.getCapacity() == capacity, "arena blocks are reused");
+  Check(0 == arena.getLiveAllocations(), "requests are released");
+
+  {
+    MessageArena::Scope scope;
+    const ArenaJson source = ArenaJson::parse("{\"a~b\": 1, \"c/d\": [1, 2, 3], \"e\": {\"f\": \"g\"}, \"x\": 1}");
+    const ArenaJson target = ArenaJson::parse("{\"a~b\": 2, \"c/d\": [1, 3], \"e\": {\"f\": \"h\", \"i\": true}}");
+    const ArenaJson patch = ArenaJson::diff(source, target);
+    Check(patch.dump() == "[{\"op\":\"replace\",\"path\":\"/a~0b\",\"value\":2},"
+                          "{\"op\":\"replace\",\"path\":\"/c~1d/1\",\"value\":3},"
+                          "{\"op\":\"remove\",\"path\":\"/c~1d/2\"},"
+                          "{\"op\":\"replace\",\"path\":\"/e/f\",\"value\":\"h\"},"
+                          "{\"op\":\"add\",\"path\":\"/e/i\",\"value\":true},"
+                          "{\"op\":\"remove\",\"path\":\"/x\"}]", "diff");
+    Check(source.patch(patch) == target, "patch from diff");
+
+    const ArenaJson moves = ArenaJson::parse(
+      "[{\"op\": \"move\", \"from\": \"/e/f\", \"path\": \"/c~1d/-\"},"
+      " {\"op\": \"copy\", \"from\": \"/x\", \"path\": \"/e/x\"},"
+      " {\"op\": \"test\", \"path\": \"/c~1d/3\", \"value\": \"g\"}]");
+    Check(source.patch(moves).dump() == "{\"a~b\":1,\"c/d\":[1,2,3,\"g\"],\"e\":{\"x\":1},\"x\":1}",
+          "patch with move, copy and test");
+  }
+
+  std::printf("%d failures\n", s_failures);
+  return 0 == s_failures ? 0 : 1;
+}
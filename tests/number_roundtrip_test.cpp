@@ -0,0 +1,212 @@
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include "nlohmann/json.hpp"
+
+using nlohmann::json;
+using nlohmann::detail::from_chars;
+using nlohmann::detail::to_chars;
+
+/**
+ * The number of random values of each kind checked by the test.
+ */
+#define ROUNDTRIP_VALUES 200000
+#define ROUNDTRIP_LITERALS 20000
+#define ROUNDTRIP_MIDPOINTS 2000
+
+/**
+ * The number of failures found so far, of which the first few are printed.
+ */
+static unsigned long s_failures = 0;
+
+/**
+ * Checks whether the two values are the same number, including the sign of
+ * zero.
+ */
+template<typename FloatType>
+static bool IsSame(FloatType a, FloatType b)
+{
+  return a == b && std::signbit(a) == std::signbit(b);
+}
+
+/**
+ * Reports a failed check.
+ */
+static void Fail(const char *what, const std::string &literal)
+{
+  if (++s_failures <= 10) {
+    std::fprintf(stderr, "%s: %s\n", what, literal.c_str());
+  }
+}
+
+/**
+ * Checks that to_chars, then from_chars, and dumping, then parsing a JSON
+ * value, both yield the given value again.
+ */
+template<typename FloatType>
+static void CheckRoundTrip(FloatType value)
+{
+  char buffer[64];
+  char *end = to_chars(buffer, buffer + sizeof(buffer), value);
+  FloatType parsed;
+  from_chars(buffer, end, parsed);
+  if (!IsSame(parsed, value)) {
+    Fail("to_chars/from_chars round trip", std::string(buffer, end));
+  }
+
+  const std::string text = json(value).dump();
+  if (!IsSame(json::parse(text).get<FloatType>(), value)) {
+    Fail("dump/parse round trip", text);
+  }
+}
+
+/**
+ * Checks that from_chars converts the given literal to the same value as the
+ * C library, for all floating-point types.
+ */
+static void CheckLiteral(const std::string &literal)
+{
+  const char *first = literal.data();
+  const char *last = first + literal.size();
+  float f;
+  double d;
+  long double l;
+  from_chars(first, last, f);
+  from_chars(first, last, d);
+  from_chars(first, last, l);
+  if (!IsSame(f, std::strtof(literal.c_str(), nullptr))) {
+    Fail("float conversion", literal);
+  }
+  if (!IsSame(d, std::strtod(literal.c_str(), nullptr))) {
+    Fail("double conversion", literal);
+  }
+  if (!IsSame(l, std::strtold(literal.c_str(), nullptr))) {
+    Fail("long double conversion", literal);
+  }
+}
+
+/**
+ * Builds a random number literal with up to 40 digits, and an exponent
+ * around the range of any of the floating-point types.
+ */
+static std::string MakeLiteral(std::mt19937_64 &random)
+{
+  std::string literal = random() % 2 ? "-" : "";
+  const int digits = 1 + static_cast<int>(random() % 40);
+  const int point = static_cast<int>(random() % (digits + 1));
+  literal += static_cast<char>('1' + random() % 9);
+  for (int i = 1; i < digits; ++i) {
+    if (i == point) {
+      literal += '.';
+    }
+    literal += static_cast<char>('0' + random() % 10);
+  }
+
+  switch (random() % 4) {
+  case 0:
+    literal += "e" + std::to_string(static_cast<int>(random() % 700) - 360);
+    break;
+  case 1:
+    literal += "e" + std::to_string(static_cast<int>(random() % 9950) - 5000);
+    break;
+  case 2:
+    literal += "E+" + std::to_string(random() % 40);
+    break;
+  default:
+    break;
+  }
+  return literal;
+}
+
+
+/**
+ * Checks the locale-independent number conversion of the JSON lexer:
+ * - Random doubles and floats (as bit patterns) survive to_chars and
+ *   from_chars, as well as a JSON dump and parse, unchanged.
+ * - Random literals, literals with hundreds of digits that lie next to the
+ *   midpoint of two doubles, and edge cases convert to the same value as
+ *   the C library in the "C" locale, for float, double and long double.
+ * - Conversions are unaffected by a locale with a decimal comma, if one is
+ *   installed.
+ */
+int main()
+{
+  std::mt19937_64 random(20240601);
+
+  for (int i = 0; i < ROUNDTRIP_VALUES; ++i) {
+    const uint64_t doubleBits = random();
+    double d;
+    std::memcpy(&d, &doubleBits, sizeof(d));
+    if (std::isfinite(d)) {
+      CheckRoundTrip(d);
+    }
+
+    const uint32_t floatBits = static_cast<uint32_t>(random());
+    float f;
+    std::memcpy(&f, &floatBits, sizeof(f));
+    if (std::isfinite(f)) {
+      CheckRoundTrip(f);
+    }
+  }
+
+  const char *edgeCases[] = {
+    "0", "-0", "0.0e-999999999999", "1e999999999999", "-1e-999999999999",
+    "1.7976931348623157e308", "1.7976931348623158e308", "1.797693134862315807937e308",
+    "4.9406564584124654e-324", "2.4703282292062327e-324", "2.4703282292062328e-324",
+    "2.2250738585072011e-308", "2.2250738585072012e-308", "9007199254740993",
+    "9007199254740993.0000000000000000000001", "1e23", "8.589973e9",
+    "3.4028235e38", "3.4028236e38", "1.4e-45", "7e-46", "16777217.000000000001",
+    "1.00000005960464477539062499999999", "1.000000059604644775390625",
+    "1.18973149535723176502e4932", "3.6451995318824746025e-4951", "1e-4952",
+    "0.000000000000000000000000000000000000000000000000000000000000000001e66"
+  };
+  for (const char *literal : edgeCases) {
+    CheckLiteral(literal);
+  }
+
+  for (int i = 0; i < ROUNDTRIP_LITERALS; ++i) {
+    CheckLiteral(MakeLiteral(random));
+  }
+
+  // The exact decimal expansions of double midpoints (exact in the x87
+  // long double) and of their neighbours, which need all their digits
+  char buffer[2048];
+  for (int i = 0; i < ROUNDTRIP_MIDPOINTS; ++i) {
+    const double d = std::ldexp(static_cast<double>(random() >> 11), static_cast<int>(random() % 2097) - 1126);
+    if (!std::isfinite(std::nextafter(d, HUGE_VAL))) {
+      continue;
+    }
+    const long double midpoint = (static_cast<long double>(d) + std::nextafter(d, HUGE_VAL)) / 2;
+    std::snprintf(buffer, sizeof(buffer), "%.780Le", midpoint);
+    CheckLiteral(buffer);
+    std::snprintf(buffer, sizeof(buffer), "%.30Le", midpoint);
+    CheckLiteral(buffer);
+  }
+
+  const char *commaLocales[] = { "de_DE.UTF-8", "de_DE", "fr_FR.UTF-8", "fr_FR", "ru_RU.UTF-8" };
+  bool localeTested = false;
+  for (const char *locale : commaLocales) {
+    if (nullptr != std::setlocale(LC_NUMERIC, locale)) {
+      const std::string text = "[1.5, -0.25e2, 1234567890.0987654321, 2.2250738585072011e-308]";
+      const json parsed = json::parse(text);
+      if (!IsSame(parsed[0].get<double>(), 1.5) || !IsSame(parsed[1].get<double>(), -25.0)
+          || !IsSame(parsed[2].get<double>(), 1234567890.0987654321)
+          || !IsSame(parsed[3].get<double>(), 2.2250738585072011e-308)) {
+        Fail("conversion under locale", locale);
+      }
+      std::setlocale(LC_NUMERIC, "C");
+      localeTested = true;
+      break;
+    }
+  }
+  if (!localeTested) {
+    std::printf("No locale with a decimal comma installed; skipped the locale check\n");
+  }
+
+  std::printf("%lu failures\n", s_failures);
+  return 0 == s_failures ? 0 : 1;
+}
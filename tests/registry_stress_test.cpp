@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "plugin_registry.h"
+
+/**
+ * The number of lookups run by each reader thread.
+ */
+#define STRESS_LOOKUPS_PER_READER 2000000
+
+/**
+ * A name looked up by the readers, which may contain NULs.
+ */
+struct LookupName
+{
+  const char *name;
+  std::size_t length;
+};
+
+#define LOOKUP_NAME(literal) { literal, sizeof(literal) - 1 }
+
+/**
+ * The names of registered plugins.
+ */
+static const LookupName s_knownNames[] = { LOOKUP_NAME("add"), LOOKUP_NAME("sub") };
+
+/**
+ * Names that must never be found, nor be added by the lookups.
+ */
+static const LookupName s_unknownNames[] = {
+  LOOKUP_NAME("mul"), LOOKUP_NAME(""), LOOKUP_NAME("add "), LOOKUP_NAME("ad"),
+  LOOKUP_NAME("operation"), LOOKUP_NAME("sub\0x")
+};
+
+/**
+ * Hammers PluginRegistry::get, and checks every result. Registered names
+ * resolve to their own entry, or to nothing while the registry is being
+ * reinitialized (which publishes an empty index until discovery ends).
+ *
+ * @param registry The registry
+ * @param seed Varies the lookup order between readers
+ * @param hits Incremented for every registered name found
+ * @param failures Incremented for every wrong result
+ */
+static void RunReader(const PluginRegistry &registry, unsigned seed,
+                      std::atomic<unsigned long> *hits, std::atomic<unsigned long> *failures)
+{
+  const std::size_t knownCount = sizeof(s_knownNames) / sizeof(s_knownNames[0]);
+  const std::size_t unknownCount = sizeof(s_unknownNames) / sizeof(s_unknownNames[0]);
+  unsigned long localHits = 0;
+  unsigned long localFailures = 0;
+
+  for (unsigned long i = 0; i < STRESS_LOOKUPS_PER_READER; ++i) {
+    const std::size_t pick = (i + seed) % (knownCount + unknownCount);
+    if (pick < knownCount) {
+      const LookupName &known = s_knownNames[pick];
+      PluginEntry *entry = registry.get("operation", 9, known.name, known.length);
+      if (nullptr == entry) {
+        continue;
+      }
+      if (entry->getName() == known.name && entry->getType() == "operation") {
+        ++localHits;
+      } else {
+        ++localFailures;
+      }
+    } else {
+      const LookupName &unknown = s_unknownNames[pick - knownCount];
+      if (nullptr != registry.get("operation", 9, unknown.name, unknown.length)) {
+        ++localFailures;
+      }
+    }
+  }
+  hits->fetch_add(localHits);
+  failures->fetch_add(localFailures);
+}
+
+
+/**
+ * Looks up plugins from all hardware threads while the registry is being
+ * reinitialized and plugins are loaded and unloaded, and checks that no
+ * lookup returns a wrong entry and that unknown names are never added.
+ */
+int main()
+{
+  PluginRegistry &registry = PluginRegistry::getSharedInstance();
+  registry.setManifestPath("");
+  registry.initialize();
+
+  const std::size_t registeredCount = registry.getAll().size();
+  if (nullptr == registry.get("operation", "add") || nullptr == registry.get("operation", "sub")) {
+    std::cerr << "The addition and subtraction plugins must be installed" << std::endl;
+    return 1;
+  }
+
+  const unsigned readerCount = std::max(4u, std::thread::hardware_concurrency());
+  std::atomic<unsigned long> hits(0);
+  std::atomic<unsigned long> failures(0);
+  std::atomic<unsigned> runningReaders(readerCount);
+  std::vector<std::thread> readers;
+  for (unsigned i = 0; i < readerCount; ++i) {
+    readers.emplace_back([&registry, &hits, &failures, &runningReaders, i] {
+      RunReader(registry, i, &hits, &failures);
+      --runningReaders;
+    });
+  }
+
+  // The writer publishes new indexes until all readers are done
+  unsigned long reinitializations = 0;
+  while (runningReaders.load() > 0) {
+    registry.initialize();
+    for (PluginEntry *entry : registry.getAll()) {
+      registry.loadPlugin(entry);
+      registry.unloadPlugin(entry);
+    }
+    ++reinitializations;
+  }
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  std::cout << readerCount << " readers, "
+            << static_cast<unsigned long>(readerCount) * STRESS_LOOKUPS_PER_READER << " lookups, "
+            << reinitializations << " reinitializations, "
+            << hits.load() << " hits, "
+            << failures.load() << " failures" << std::endl;
+
+  if (0 == hits.load()) {
+    std::cerr << "No registered plugin was ever found" << std::endl;
+    return 1;
+  }
+  if (registry.getAll().size() != registeredCount) {
+    std::cerr << "Lookups changed the number of registered plugins" << std::endl;
+    return 1;
+  }
+  return 0 == failures.load() ? 0 : 1;
+}
@@ -0,0 +1,83 @@
+#include <atomic>
+#include <iostream>
+#include <sstream>
+#include "calculator_engine.h"
+#include "plugin_registry.h"
+
+/**
+ * The number of operations submitted before the engine is stopped.
+ */
+#define STOP_OPERATIONS 20000
+
+/**
+ * The number of times the callback of each operation submits a follow-up.
+ */
+#define STOP_RESUBMISSIONS 3
+
+/**
+ * Submits an operation whose callback submits a follow-up, until the given
+ * number of follow-ups is exhausted.
+ *
+ * @param engine The engine
+ * @param resubmissions The number of follow-ups left
+ * @param completed Incremented for every completed operation
+ * @param refused Incremented for every operation that completed with -1
+ */
+static void SubmitChain(CalculatorEngine &engine, int resubmissions,
+                        std::atomic<unsigned long> *completed, std::atomic<unsigned long> *refused)
+{
+  engine.submitOperation("add", 1, 2, [&engine, resubmissions, completed, refused](double result) {
+    if (-1 == result) {
+      ++*refused;
+    }
+    ++*completed;
+    if (resubmissions > 0) {
+      SubmitChain(engine, resubmissions - 1, completed, refused);
+    }
+  });
+}
+
+
+/**
+ * Stops the engine while the callbacks of the submitted operations submit
+ * follow-ups, and checks that every operation completes and that stop
+ * leaves no workers behind.
+ */
+int main()
+{
+  PluginRegistry::getSharedInstance().setManifestPath("");
+  CalculatorEngine engine;
+  engine.setWorkerCount(4);
+
+  std::ostringstream discarded;
+  std::streambuf *output = std::cout.rdbuf(discarded.rdbuf());
+  engine.start(true);
+  std::cout.rdbuf(output);
+  if (!engine.isOperationSupported("add")) {
+    std::cerr << "The addition plugin must be installed" << std::endl;
+    return 1;
+  }
+
+  std::atomic<unsigned long> completed(0);
+  std::atomic<unsigned long> refused(0);
+  for (int i = 0; i < STOP_OPERATIONS; ++i) {
+    SubmitChain(engine, STOP_RESUBMISSIONS, &completed, &refused);
+  }
+  std::cout.rdbuf(discarded.rdbuf());
+  engine.stop();
+  std::cout.rdbuf(output);
+
+  const unsigned long expected = static_cast<unsigned long>(STOP_OPERATIONS) * (STOP_RESUBMISSIONS + 1);
+  std::cout << completed.load() << " operations completed, "
+            << refused.load() << " refused while stopping" << std::endl;
+
+  if (!engine.getWorkerStats().empty()) {
+    std::cerr << "Callbacks started new workers while the engine was stopping" << std::endl;
+    return 1;
+  }
+  if (completed.load() != expected) {
+    std::cerr << "Expected " << expected << " completed operations" << std::endl;
+    return 1;
+  }
+  return 0;
+}